@@ -0,0 +1,11 @@
+#! /bin/bash
+
+set -euo pipefail
+
+BASE_PATH="$(dirname "$0")/../.."
+cd "$BASE_PATH"
+
+# Usage: benchmark.sh [results.tsv] [seconds]
+OUTPUT="${1:-/dev/stdout}"
+SECONDS_PER_CASE="${2:-0.25}"
+build/RomanizerBenchmark src/main/resources/benchmark/corpus.tsv "$SECONDS_PER_CASE" > "$OUTPUT"
@@ -41,5 +41,123 @@ for test in $(ls src/test/c/reject/); do
 done
 echo ""
 
+echo "Compiler should generate..."
+echo ""
+
+# Every output test is a directory with the "input" program, the "arguments"
+# of the compiler (if any), the "expected" files of the output directory, and
+# the "warnings" that the compiler must report (if any, one per line).
+LOG="$(mktemp)"
+
+function compile() {
+	local TEST="$1"
+	local OUTPUT="$2"
+	local ARGUMENTS=""
+	if [ -f "$TEST/arguments" ]; then
+		ARGUMENTS="$(cat "$TEST/arguments")"
+	fi
+	build/Compiler $ARGUMENTS ${JOBS:-} -d "$OUTPUT" < "${3:-$TEST/input}" >"$LOG" 2>&1
+}
+
+function compare() {
+	local TEST="$1"
+	local OUTPUT="$2"
+	for EXPECTED in "$TEST"/expected/*; do
+		cmp --silent "$EXPECTED" "$OUTPUT/$(basename "$EXPECTED")" || return 1
+	done
+	if [ -f "$TEST/warnings" ]; then
+		while IFS= read -r WARNING; do
+			grep --quiet --fixed-strings -- "$WARNING" "$LOG" || return 1
+		done < "$TEST/warnings"
+	fi
+}
+
+# The output (and the warnings) must be the same from scratch, from the cache
+# of the previous compilation, from a corrupted cache, and from the cache of
+# another program (compiled without the dictionary, so only its cache is kept,
+# and it must not be reused). If the test has an "edit" directory, its input is then compiled
+# over the output of the test, and must leave there its own expected files.
+# Finally, generating with several jobs must not change the output (but the
+# HTML preview is always generated by one).
+for test in $(ls src/test/c/output/); do
+	TEST="src/test/c/output/$test"
+	OUTPUT="$(mktemp --directory)"
+	FAILURE=""
+	if ! compile "$TEST" "$OUTPUT" || ! compare "$TEST" "$OUTPUT"; then
+		FAILURE="from scratch"
+	elif ! compile "$TEST" "$OUTPUT" || ! compare "$TEST" "$OUTPUT"; then
+		FAILURE="from its cache"
+	else
+		for CACHE in "$OUTPUT"/.*.cache; do
+			[ -f "$CACHE" ] || continue
+			head --bytes=$(($(wc --bytes < "$CACHE") / 2)) "$CACHE" > "$CACHE.corrupted"
+			mv "$CACHE.corrupted" "$CACHE"
+		done
+		if ! compile "$TEST" "$OUTPUT" || ! compare "$TEST" "$OUTPUT"; then
+			FAILURE="from a corrupted cache"
+		else
+			rm --force --recursive "$OUTPUT"
+			OUTPUT="$(mktemp --directory)"
+			(cat "$TEST/input"; echo "Changed") > "$OUTPUT/changed"
+			PINYIN_DICTIONARY="$OUTPUT/missing" compile "$TEST" "$OUTPUT" "$OUTPUT/changed"
+			find "$OUTPUT" -type f -not -name ".*.cache" -delete
+			if ! compile "$TEST" "$OUTPUT" || ! compare "$TEST" "$OUTPUT"; then
+				FAILURE="from the cache of another program"
+			elif [ -d "$TEST/edit" ]; then
+				if ! compile "$TEST" "$OUTPUT" "$TEST/edit/input" || ! compare "$TEST/edit" "$OUTPUT"; then
+					FAILURE="after its edit"
+				fi
+			fi
+		fi
+	fi
+	if [ -z "$FAILURE" ] && ! grep --quiet --no-messages -- "-H" "$TEST/arguments"; then
+		rm --force --recursive "$OUTPUT"
+		OUTPUT="$(mktemp --directory)"
+		if ! JOBS="-j 4" compile "$TEST" "$OUTPUT" || ! compare "$TEST" "$OUTPUT"; then
+			FAILURE="with 4 jobs"
+		fi
+	fi
+	rm --force --recursive "$OUTPUT"
+	if [ -z "$FAILURE" ]; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it differs${OFF} ($FAILURE)"
+	fi
+done
+rm --force "$LOG"
+echo ""
+
+echo "Benchmark should measure..."
+echo ""
+
+# Every scheme is measured over its 4 corpora with both APIs, in a line of 11
+# columns, and appending into a reused builder never allocates.
+BENCHMARK="$(mktemp)"
+HEADER="$(printf "language\tscheme\tcorpus\tapi\tcalls\tbytes\tcodepoints\tseconds\tmegabytes_per_second\tcodepoints_per_second\tallocations_per_call")"
+if build/RomanizerBenchmark src/main/resources/benchmark/corpus.tsv 0.001 > "$BENCHMARK" \
+	&& [ "$(head --lines=1 "$BENCHMARK")" == "$HEADER" ] \
+	&& awk -F '\t' 'NR > 1 {
+			if (NF != 11 || $5 < 1 || $6 < 1 || ($4 == "append" && $11 != "0.000" && $11 != "NA")) invalid = 1
+			++cases[$1 " " $2]
+		}
+		END {
+			for (scheme in cases) if (cases[scheme] != 8) invalid = 1
+			exit invalid || NR < 9
+		}' "$BENCHMARK"; then
+	echo -e "    romanizer-benchmark, ${GREEN}and it does${OFF}"
+else
+	STATUS=1
+	echo -e "    romanizer-benchmark, ${RED}but it doesn't${OFF}"
+fi
+rm --force "$BENCHMARK"
+echo ""
+
+echo "Compiler modules should pass..."
+echo ""
+
+LOGGING_LEVEL=CRITICAL build/UnitTests || STATUS=1
+echo ""
+
 echo "All done."
 exit $STATUS
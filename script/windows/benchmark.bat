@@ -0,0 +1,9 @@
+@SETLOCAL
+
+@set BASE_PATH=%~dp0
+@set BASE_PATH=%BASE_PATH:~0,-1%
+@set BASE_PATH=%BASE_PATH%\..\..
+
+@%BASE_PATH%\build\Debug\RomanizerBenchmark.exe %BASE_PATH%\src\main\resources\benchmark\corpus.tsv %1
+
+@ENDLOCAL
@@ -33,6 +33,57 @@
 		@echo     "%%f", [91mbut it accepts[0m ^(status !RESULT!^)
 	)
 )
+@echo:
+
+@echo Compiler should generate...
+@echo:
+
+@rem Every output test is compiled twice (the second time, from its cache), and
+@rem both times its output directory must have the expected files. If it has an
+@rem "edit" directory, its input is then compiled over that output directory,
+@rem which must have the expected files of the edit.
+@for /f %%t in ('dir /b !BASE_PATH!\src\test\c\output') do @(
+	@set TEST=!BASE_PATH!\src\test\c\output\%%t
+	@set OUTPUT=%TEMP%\langtex-%%t
+	@set ARGUMENTS=
+	@if exist "!TEST!\arguments" set /p ARGUMENTS=<"!TEST!\arguments"
+	@rmdir /s /q "!OUTPUT!" >nul 2>&1
+	@mkdir "!OUTPUT!"
+	@set RESULT=0
+	@for %%r in (1 2) do @(
+		@type "!TEST!\input" | !BASE_PATH!\build\Debug\Compiler.exe !ARGUMENTS! -d "!OUTPUT!" >nul 2>&1
+		@if !ERRORLEVEL! neq 0 set RESULT=1
+		@for /f %%e in ('dir /b "!TEST!\expected"') do @(
+			@fc "!TEST!\expected\%%e" "!OUTPUT!\%%e" >nul 2>&1
+			@if !ERRORLEVEL! neq 0 set RESULT=1
+		)
+	)
+	@if exist "!TEST!\edit" (
+		@type "!TEST!\edit\input" | !BASE_PATH!\build\Debug\Compiler.exe !ARGUMENTS! -d "!OUTPUT!" >nul 2>&1
+		@if !ERRORLEVEL! neq 0 set RESULT=1
+		@for /f %%e in ('dir /b "!TEST!\edit\expected"') do @(
+			@fc "!TEST!\edit\expected\%%e" "!OUTPUT!\%%e" >nul 2>&1
+			@if !ERRORLEVEL! neq 0 set RESULT=1
+		)
+	)
+	@rmdir /s /q "!OUTPUT!"
+	if !RESULT! equ 0 (
+		@echo     "%%t", [92mand it does[0m
+	) else (
+		@set STATUS=1
+		@echo     "%%t", [91mbut it differs[0m
+	)
+)
+
+@echo:
+
+@echo Compiler modules should pass...
+@echo:
+
+@set LOGGING_LEVEL=CRITICAL
+@!BASE_PATH!\build\Debug\UnitTests.exe
+@if !ERRORLEVEL! neq 0 set STATUS=1
+@echo:
 
 @exit /B %STATUS%
 
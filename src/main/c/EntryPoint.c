@@ -1,6 +1,10 @@
+#include "backend/code-generation/BlockCache.h"
 #include "backend/code-generation/Generator.h"
+#include "backend/code-generation/HtmlGenerator.h"
 #include "backend/domain-specific/SemanticAnalyzer.h"
+#include "backend/romanizers/PinyinDictionary.h"
 #include "frontend/lexical-analysis/FlexActions.h"
+#include "frontend/lexical-analysis/SourceInput.h"
 #include "frontend/syntactic-analysis/LangTeXAST.h"
 #include "frontend/syntactic-analysis/BisonActions.h"
 #include "frontend/syntactic-analysis/SyntacticAnalyzer.h"
@@ -20,14 +24,24 @@ const int main(const int count, char **arguments)
 {
 	Logger *logger = createLogger("EntryPoint");
 	initializeFlexActionsModule();
+	initializeSourceInputModule();
 	initializeBisonActionsModule();
 	initializeSyntacticAnalyzerModule();
 	initializeRenameMeModule();
 	initializeSemanticAnalyzer();
+	initializeBlockCacheModule();
+	initializeRomanizationCacheModule();
+	initializePinyinDictionaryModule();
 	initializeGeneratorModule();
+	initializeHtmlGeneratorModule();
 
 	int opt;
     bool inputFlag = false;
+    bool splitFlag = false;
+    unsigned int jobs = 1;
+    unsigned int artifacts = 0;
+    bool htmlFlag = false;
+    bool encodingFlag = true;
     char *outputDir = NULL;
 	char *fileName = NULL;
 
@@ -39,10 +53,15 @@ const int main(const int count, char **arguments)
 
 	    struct option long_options[] = {
         {"input", no_argument, 0, 'i'},
+        {"split", no_argument, 0, 's'},
+        {"jobs", required_argument, 0, 'j'},
+        {"artifacts", required_argument, 0, 'a'},
+        {"html", no_argument, 0, 'H'},
+        {"input-encoding", required_argument, 0, 'e'},
         {0, 0, 0, 0}
     };
 
-    while (count > 1 && (opt = getopt_long(count, arguments, "id:o:", long_options, NULL)) != -1) {
+    while (count > 1 && (opt = getopt_long(count, arguments, "id:o:sj:a:He:", long_options, NULL)) != -1) {
         switch (opt) {
             case 'd':
                 outputDir = optarg;
@@ -56,11 +75,46 @@ const int main(const int count, char **arguments)
                 inputFlag = true;
 				logInformation(logger, "Compiling in input mode (no prologue)");
                 break;
+            case 's':
+                splitFlag = true;
+				logInformation(logger, "Compiling in split mode (one file per chapter)");
+                break;
+            case 'j':
+                jobs = atoi(optarg) < 1 ? 1 : (unsigned int) atoi(optarg);
+				logInformation(logger, "Generating with %u jobs", jobs);
+                break;
+            case 'a':
+                for (char *artifact = optarg; artifact != NULL;) {
+                    char *separator = strchr(artifact, ',');
+                    if (separator != NULL) *separator = '\0';
+                    if (strcmp(artifact, "worksheet") == 0) artifacts |= ARTIFACT_WORKSHEET;
+                    else if (strcmp(artifact, "answers") == 0) artifacts |= ARTIFACT_ANSWER_KEY;
+                    else if (strcmp(artifact, "flashcards") == 0) artifacts |= ARTIFACT_FLASHCARDS;
+                    else logWarning(logger, "Unknown artifact: %s", artifact);
+                    artifact = separator != NULL ? separator + 1 : NULL;
+                }
+				logInformation(logger, "Emitting additional artifacts: %u", artifacts);
+                break;
+            case 'H':
+                htmlFlag = true;
+				logInformation(logger, "Generating an HTML preview");
+                break;
+            case 'e':
+                encodingFlag = setSourceInputEncoding(optarg);
+                if (!encodingFlag) logError(logger, "Unknown input encoding: %s", optarg);
+				else logInformation(logger, "Input encoding is %s", optarg);
+                break;
             default:
                 break;
         }
     }
 
+	// The HTML preview is a single document, generated on its own.
+	const bool optionsFlag = !htmlFlag || !(inputFlag || splitFlag || 1 < jobs || artifacts);
+	if (!optionsFlag)
+	{
+		logError(logger, "The HTML preview can't be combined with -i, -s, -j or -a.");
+	}
 	if (fileName == NULL)
 	{
 		fileName = calloc(1, 9);
@@ -72,11 +126,14 @@ const int main(const int count, char **arguments)
 	// Begin compilation process.
 	CompilerState compilerState = {
 		.abstractSyntaxtTree = NULL,
-		.succeed = false
+		.succeed = false,
+		.blockCache = NULL
 	};
 
 
-	const SyntacticAnalysisStatus syntacticAnalysisStatus = parse(&compilerState);
+	// An unknown encoding can't be read, and incompatible options can't be
+	// generated, so in both cases the input isn't even parsed.
+	const SyntacticAnalysisStatus syntacticAnalysisStatus = encodingFlag && optionsFlag ? parse(&compilerState) : REJECT;
 	CompilationStatus compilationStatus = SUCCEED;
 	Program *program = compilerState.abstractSyntaxtTree;
 	if (syntacticAnalysisStatus == ACCEPT)
@@ -85,10 +142,24 @@ const int main(const int count, char **arguments)
 		// Beginning of the Backend... ------------------------------------------------------------
 		logDebugging(logger, "Validating the input program...");
 
-		SemanticAnalysisStatus semanticResult = analyzeProgram(program);
+		// The incremental cache lives next to the output, so it requires a directory.
+		if (outputDir != NULL)
+		{
+			compilerState.blockCache = loadBlockCache(outputDir, fileName);
+			planBlockCache(compilerState.blockCache, program);
+		}
+
+		SemanticAnalysisStatus semanticResult = analyzeProgram(program, compilerState.blockCache);
 		if (semanticResult == SEMANTIC_ANALYSIS_ACCEPT)
 		{
-			generate(outputDir, fileName, inputFlag, &compilerState);
+			if (htmlFlag)
+			{
+				generateHtml(outputDir, fileName, &compilerState);
+			}
+			else
+			{
+				generate(outputDir, fileName, inputFlag, splitFlag, jobs, artifacts, &compilerState);
+			}
 		}
 		else
 		{
@@ -105,14 +176,20 @@ const int main(const int count, char **arguments)
 	}
 
 	free(fileName);
+	destroyBlockCache(compilerState.blockCache);
 	logDebugging(logger, "Releasing AST resources...");
 	releaseProgram(program);
 	logDebugging(logger, "Releasing modules resources...");
 
+	shutdownHtmlGeneratorModule();
 	shutdownGeneratorModule();
+	shutdownPinyinDictionaryModule();
+	shutdownRomanizationCacheModule();
+	shutdownBlockCacheModule();
 	shutdownSemanticAnalyzer();
 	shutdownRenameMeModule();
 	shutdownSyntacticAnalyzerModule();
+	shutdownSourceInputModule();
 	shutdownBisonActionsModule();
 	shutdownFlexActionsModule();
 	logDebugging(logger, "Compilation is done.");
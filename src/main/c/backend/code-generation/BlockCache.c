@@ -0,0 +1,515 @@
+#include "BlockCache.h"
+
+/* MODULE INTERNAL STATE */
+
+// Bump this value whenever the format of the file changes.
+static const int _formatVersion = 3;
+static const char * _magic = "LANGTEX-BLOCK-CACHE";
+static Logger * _logger = NULL;
+
+void initializeBlockCacheModule()
+{
+    _logger = createLogger("BlockCache");
+}
+
+void shutdownBlockCacheModule()
+{
+    if (_logger != NULL)
+    {
+        destroyLogger(_logger);
+    }
+}
+
+/* PRIVATE FUNCTIONS */
+
+static boolean _compilerFingerprint(Hash * fingerprint);
+static int _compareBlocks(const void * first, const void * second);
+static char * _readFile(const char * path, size_t * length);
+static void _parseCache(BlockCache * blockCache, char * contents, size_t length);
+static const CachedBlock * _findPrevious(const BlockCache * blockCache, const CachedBlock * block);
+static void _serializeInteger(StringBuilder * key, const int64_t value);
+static void _serializeString(StringBuilder * key, const char * string);
+static void _serializeContent(StringBuilder * key, Content * content);
+static void _serializeContentList(StringBuilder * key, ContentList * contentList);
+static void _serializeElement(StringBuilder * key, Element * element);
+static void _serializeCommand(StringBuilder * key, Command * command);
+static void _serializeLangtexCommand(StringBuilder * key, LangtexCommand * command);
+static void _serializeLangtexCommandList(StringBuilder * key, LangtexCommandList * commandList);
+static void _serializeParamList(StringBuilder * key, LangtexParamList * paramList);
+
+/**
+ * Identifies the compiler that produced a cache, so a rebuilt compiler (that
+ * may generate a different output for the same source) never reuses it. The
+ * tables that are loaded at runtime change the output too, so they are part
+ * of it (the others are built into the compiler). Returns false if the
+ * executable can't be identified (e.g., there is no "/proc"), as a cache of
+ * any build would be reused then.
+ */
+static boolean _compilerFingerprint(Hash * fingerprint)
+{
+    struct stat st = {0};
+    if (stat("/proc/self/exe", &st) != 0)
+    {
+        return false;
+    }
+    Hash hash = hashInteger(HASH_SEED, _formatVersion);
+    hash = hashInteger(hash, (int64_t) st.st_size);
+    hash = hashInteger(hash, (int64_t) st.st_mtime);
+    *fingerprint = hashPinyinDictionaryIdentity(hash);
+    return true;
+}
+
+static int _compareBlocks(const void * first, const void * second)
+{
+    const CachedBlock * a = first;
+    const CachedBlock * b = second;
+    if (a->hash != b->hash)
+    {
+        return (a->hash > b->hash) - (a->hash < b->hash);
+    }
+    if (a->keyLength != b->keyLength)
+    {
+        return (a->keyLength > b->keyLength) - (a->keyLength < b->keyLength);
+    }
+    return memcmp(a->key, b->key, a->keyLength);
+}
+
+static char * _readFile(const char * path, size_t * length)
+{
+    FILE * file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    char * contents = NULL;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        const long size = ftell(file);
+        if (0 <= size && fseek(file, 0, SEEK_SET) == 0)
+        {
+            contents = malloc(size + 1);
+            if (contents != NULL && fread(contents, 1, size, file) == (size_t) size)
+            {
+                contents[size] = '\0';
+                *length = size;
+            }
+            else
+            {
+                free(contents);
+                contents = NULL;
+            }
+        }
+    }
+    fclose(file);
+    return contents;
+}
+
+/**
+ * Parses the cache file. The format is a header line with the magic, the
+ * version and the fingerprint, followed by one entry per block: a line with
+ * the hash, the lengths of the key and of the fragment and the warnings of
+ * its analysis, and then the (binary) key and the fragment, terminated by a
+ * newline.
+ */
+static void _parseCache(BlockCache * blockCache, char * contents, size_t length)
+{
+    char * end = contents + length;
+    char * line = strchr(contents, '\n');
+    int version = 0;
+    Hash fingerprint = 0;
+    char magic[32] = {0};
+    if (line == NULL
+        || sscanf(contents, "%31s %d %" SCNx64, magic, &version, &fingerprint) != 3
+        || strcmp(magic, _magic) != 0
+        || version != _formatVersion
+        || fingerprint != blockCache->fingerprint)
+    {
+        logDebugging(_logger, "Ignoring stale block cache: %s", blockCache->path);
+        return;
+    }
+
+    size_t capacity = 64;
+    CachedBlock * previous = calloc(capacity, sizeof(CachedBlock));
+    size_t count = 0;
+    char * cursor = line + 1;
+    while (cursor < end)
+    {
+        Hash hash = 0;
+        size_t keyLength = 0;
+        size_t fragmentLength = 0;
+        size_t warnings = 0;
+        char * header = cursor;
+        line = memchr(header, '\n', end - header);
+        if (line == NULL || sscanf(header, "%" SCNx64 " %zu %zu %zu", &hash, &keyLength, &fragmentLength, &warnings) != 4
+            || (size_t) (end - (line + 1)) <= keyLength
+            || (size_t) (end - (line + 1)) - keyLength < fragmentLength + 1
+            || line[1 + keyLength + fragmentLength] != '\n')
+        {
+            logWarning(_logger, "Corrupted block cache, it will be rebuilt: %s", blockCache->path);
+            free(previous);
+            return;
+        }
+        if (count == capacity)
+        {
+            capacity *= 2;
+            previous = realloc(previous, capacity * sizeof(CachedBlock));
+        }
+        char * key = line + 1;
+        char * fragment = key + keyLength;
+        fragment[fragmentLength] = '\0';
+        previous[count++] = (CachedBlock){
+            .hash = hash,
+            .key = key,
+            .keyLength = keyLength,
+            .fragment = fragment,
+            .length = fragmentLength,
+            .cached = true,
+            .owned = false,
+            .warnings = warnings};
+        cursor = fragment + fragmentLength + 1;
+    }
+    qsort(previous, count, sizeof(CachedBlock), &_compareBlocks);
+    blockCache->previous = previous;
+    blockCache->previousCount = count;
+}
+
+static const CachedBlock * _findPrevious(const BlockCache * blockCache, const CachedBlock * block)
+{
+    if (blockCache->previous == NULL)
+    {
+        return NULL;
+    }
+    return bsearch(block, blockCache->previous, blockCache->previousCount, sizeof(CachedBlock), &_compareBlocks);
+}
+
+/**
+ * Structural serialization of the AST, the key of a block. Every node writes
+ * its type before its children, and every list its end, so that different
+ * trees never have the same key (the hash only locates the candidates).
+ */
+static void _serializeInteger(StringBuilder * key, const int64_t value)
+{
+    appendStringWithLength(key, (const char *) &value, sizeof(value));
+}
+
+static void _serializeString(StringBuilder * key, const char * string)
+{
+    if (string == NULL)
+    {
+        appendCharacter(key, 'N');
+        return;
+    }
+    appendCharacter(key, 'S');
+    // The terminator is part of the key, as the texts never contain it.
+    appendStringWithLength(key, string, strlen(string) + 1);
+}
+
+static void _serializeContent(StringBuilder * key, Content * content)
+{
+    for (; content != NULL; content = content->sequenceContent)
+    {
+        _serializeInteger(key, content->type);
+        _serializeElement(key, content->sequenceElement);
+    }
+    _serializeInteger(key, -1);
+}
+
+static void _serializeContentList(StringBuilder * key, ContentList * contentList)
+{
+    for (; contentList != NULL; contentList = contentList->next)
+    {
+        _serializeContent(key, contentList->content);
+    }
+    _serializeInteger(key, -1);
+}
+
+static void _serializeElement(StringBuilder * key, Element * element)
+{
+    if (element == NULL)
+    {
+        _serializeInteger(key, -1);
+        return;
+    }
+    _serializeInteger(key, element->type);
+    switch (element->type)
+    {
+    case LANGTEX_COMMAND:
+        _serializeLangtexCommand(key, element->langtexCommand);
+        break;
+    case LATEX_COMMAND:
+        _serializeCommand(key, element->command);
+        break;
+    case LATEX_TEXT:
+        _serializeString(key, element->text ? element->text->text : NULL);
+        break;
+    default:
+        break;
+    }
+}
+
+static void _serializeCommand(StringBuilder * key, Command * command)
+{
+    if (command == NULL)
+    {
+        _serializeInteger(key, -1);
+        return;
+    }
+    _serializeInteger(key, command->type);
+    switch (command->type)
+    {
+    case PARAMETERIZED:
+        _serializeString(key, command->parameterizedCommand);
+        _serializeContentList(key, command->parameterizedContentList);
+        break;
+    case ENVIRONMENT:
+        _serializeString(key, command->environmentLeftText ? command->environmentLeftText->text : NULL);
+        _serializeContentList(key, command->environmentCommandArgs);
+        _serializeContent(key, command->environmentParameters);
+        _serializeContent(key, command->environmentContent);
+        break;
+    default:
+        break;
+    }
+}
+
+static void _serializeLangtexCommand(StringBuilder * key, LangtexCommand * command)
+{
+    if (command == NULL)
+    {
+        _serializeInteger(key, -1);
+        return;
+    }
+    _serializeInteger(key, command->type);
+    _serializeParamList(key, command->parameters);
+    switch (command->type)
+    {
+    case LANGTEX_TRANSLATE:
+        _serializeContent(key, command->leftText);
+        _serializeContent(key, command->rightText);
+        break;
+    case LANGTEX_DIALOG:
+    case LANGTEX_TABLE:
+        _serializeLangtexCommandList(key, command->langtexCommandList);
+        break;
+    case LANGTEX_SPEAKER:
+    case LANGTEX_PROMPT:
+    case LANGTEX_BLOCK:
+        _serializeContent(key, command->content);
+        break;
+    case LANGTEX_ROW:
+    case LANGTEX_OPTIONS:
+    case LANGTEX_ANSWERS:
+        _serializeContentList(key, command->contentList);
+        break;
+    case LANGTEX_EXERCISE:
+        _serializeLangtexCommand(key, command->prompt);
+        _serializeLangtexCommand(key, command->options);
+        _serializeLangtexCommand(key, command->answers);
+        break;
+    default:
+        break;
+    }
+}
+
+static void _serializeLangtexCommandList(StringBuilder * key, LangtexCommandList * commandList)
+{
+    for (; commandList != NULL; commandList = commandList->next)
+    {
+        _serializeLangtexCommand(key, commandList->command);
+    }
+    _serializeInteger(key, -1);
+}
+
+static void _serializeParamList(StringBuilder * key, LangtexParamList * paramList)
+{
+    for (; paramList != NULL && paramList->param != NULL; paramList = paramList->next)
+    {
+        LangtexParam * param = paramList->param;
+        _serializeString(key, param->key);
+        _serializeInteger(key, param->type);
+        switch (param->type)
+        {
+        case STRING_PARAMETER:
+            _serializeString(key, param->value.stringParam);
+            break;
+        case INTEGER_PARAMETER:
+            _serializeInteger(key, param->value.intParam);
+            break;
+        case BOOLEAN_PARAMETER:
+            _serializeInteger(key, param->value.boolParam);
+            break;
+        }
+    }
+    _serializeInteger(key, -1);
+}
+
+/* PUBLIC FUNCTIONS */
+
+BlockCache * loadBlockCache(const char * outputDirectory, const char * fileName)
+{
+    Hash fingerprint = 0;
+    if (!_compilerFingerprint(&fingerprint))
+    {
+        logWarning(_logger, "The compiler executable can't be identified, so the block cache is disabled");
+        return NULL;
+    }
+    BlockCache * blockCache = calloc(1, sizeof(BlockCache));
+    size_t length = strlen(outputDirectory);
+    const boolean needsSlash = (length > 0 && outputDirectory[length - 1] != '/');
+    blockCache->path = malloc(length + strlen(fileName) + strlen("/..cache") + 1);
+    sprintf(blockCache->path, "%s%s.%s.cache", outputDirectory, needsSlash ? "/" : "", fileName);
+    blockCache->fingerprint = fingerprint;
+
+    size_t contentsLength = 0;
+    blockCache->contents = _readFile(blockCache->path, &contentsLength);
+    if (blockCache->contents != NULL)
+    {
+        _parseCache(blockCache, blockCache->contents, contentsLength);
+        logDebugging(_logger, "Loaded %zu cached blocks from: %s", blockCache->previousCount, blockCache->path);
+    }
+    return blockCache;
+}
+
+void planBlockCache(BlockCache * blockCache, Program * program)
+{
+    if (blockCache == NULL || program == NULL)
+    {
+        return;
+    }
+    size_t count = 0;
+    for (Content * content = program->content; content != NULL; content = content->sequenceContent)
+    {
+        ++count;
+    }
+    blockCache->blocks = calloc(count ? count : 1, sizeof(CachedBlock));
+    blockCache->blockCount = count;
+
+    size_t index = 0;
+    size_t hits = 0;
+    StringBuilder key = {0};
+    for (Content * content = program->content; content != NULL; content = content->sequenceContent, ++index)
+    {
+        CachedBlock * block = &blockCache->blocks[index];
+        clearStringBuilder(&key);
+        _serializeElement(&key, content->sequenceElement);
+        block->keyLength = key.length;
+        block->key = malloc(key.length ? key.length : 1);
+        memcpy(block->key, key.data, key.length);
+        block->hash = hashBytes(HASH_SEED, block->key, block->keyLength);
+        const CachedBlock * previous = _findPrevious(blockCache, block);
+        if (previous != NULL)
+        {
+            // The key stays the one of this block, that owns it.
+            char * ownKey = block->key;
+            *block = *previous;
+            block->key = ownKey;
+            ++hits;
+        }
+    }
+    releaseStringBuilder(&key);
+    logDebugging(_logger, "Reusing %zu of %zu top-level blocks", hits, count);
+}
+
+const CachedBlock * getCachedBlock(const BlockCache * blockCache, const size_t index)
+{
+    if (blockCache == NULL || blockCache->blockCount <= index || !blockCache->blocks[index].cached)
+    {
+        return NULL;
+    }
+    return &blockCache->blocks[index];
+}
+
+void storeBlockAnalysis(BlockCache * blockCache, const size_t index, const size_t warnings)
+{
+    if (blockCache != NULL && index < blockCache->blockCount)
+    {
+        blockCache->blocks[index].warnings = warnings;
+    }
+}
+
+void storeBlockFragment(BlockCache * blockCache, const size_t index, char * fragment)
+{
+    if (blockCache == NULL || blockCache->blockCount <= index)
+    {
+        free(fragment);
+        return;
+    }
+    CachedBlock * block = &blockCache->blocks[index];
+    if (block->owned)
+    {
+        free(block->fragment);
+    }
+    block->fragment = fragment;
+    block->length = fragment ? strlen(fragment) : 0;
+    block->owned = fragment != NULL;
+}
+
+boolean saveBlockCache(BlockCache * blockCache)
+{
+    if (blockCache == NULL)
+    {
+        return false;
+    }
+    CachedBlock * blocks = malloc((blockCache->blockCount ? blockCache->blockCount : 1) * sizeof(CachedBlock));
+    size_t count = 0;
+    for (size_t k = 0; k < blockCache->blockCount; ++k)
+    {
+        if (blockCache->blocks[k].fragment == NULL)
+        {
+            logWarning(_logger, "Block %zu was never generated, it will not be cached", k);
+            continue;
+        }
+        blocks[count++] = blockCache->blocks[k];
+    }
+    qsort(blocks, count, sizeof(CachedBlock), &_compareBlocks);
+
+    char * temporaryPath = malloc(strlen(blockCache->path) + strlen(".tmp") + 1);
+    sprintf(temporaryPath, "%s.tmp", blockCache->path);
+    FILE * file = fopen(temporaryPath, "wb");
+    boolean succeed = file != NULL;
+    if (succeed)
+    {
+        fprintf(file, "%s %d %016" PRIx64 "\n", _magic, _formatVersion, blockCache->fingerprint);
+        for (size_t k = 0; k < count; ++k)
+        {
+            // Identical blocks share the same entry.
+            if (0 < k && _compareBlocks(&blocks[k], &blocks[k - 1]) == 0)
+            {
+                continue;
+            }
+            fprintf(file, "%016" PRIx64 " %zu %zu %zu\n", blocks[k].hash, blocks[k].keyLength, blocks[k].length, blocks[k].warnings);
+            fwrite(blocks[k].key, 1, blocks[k].keyLength, file);
+            fwrite(blocks[k].fragment, 1, blocks[k].length, file);
+            fputc('\n', file);
+        }
+        succeed = fclose(file) == 0 && rename(temporaryPath, blockCache->path) == 0;
+    }
+    if (!succeed)
+    {
+        logWarning(_logger, "Could not write the block cache: %s", blockCache->path);
+        remove(temporaryPath);
+    }
+    free(temporaryPath);
+    free(blocks);
+    return succeed;
+}
+
+void destroyBlockCache(BlockCache * blockCache)
+{
+    if (blockCache != NULL)
+    {
+        for (size_t k = 0; k < blockCache->blockCount; ++k)
+        {
+            if (blockCache->blocks[k].owned)
+            {
+                free(blockCache->blocks[k].fragment);
+            }
+            free(blockCache->blocks[k].key);
+        }
+        free(blockCache->blocks);
+        free(blockCache->previous);
+        free(blockCache->contents);
+        free(blockCache->path);
+        free(blockCache);
+    }
+}
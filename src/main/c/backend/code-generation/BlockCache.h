@@ -0,0 +1,100 @@
+#ifndef BLOCK_CACHE_HEADER
+#define BLOCK_CACHE_HEADER
+
+#include "../../frontend/syntactic-analysis/LangTeXAST.h"
+#include "../romanizers/PinyinDictionary.h"
+#include "../../shared/Hash.h"
+#include "../../shared/Logger.h"
+#include "../../shared/StringBuilder.h"
+#include "../../shared/Type.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/**
+ * The generated LaTeX of a single top-level element of the program, keyed by
+ * the serialization of its subtree (and located by the hash of that key).
+ */
+typedef struct {
+    Hash hash;
+    char * key;
+    size_t keyLength;
+    char * fragment;
+    size_t length;
+    // The fragment comes from a previous compilation (i.e., the block is clean).
+    boolean cached;
+    // The fragment was generated in this compilation, and must be freed.
+    boolean owned;
+    // The warnings of its semantic analysis (a cached block was always accepted).
+    size_t warnings;
+} CachedBlock;
+
+/**
+ * A sidecar cache, stored in the output directory, that allows to reuse the
+ * analysis and the generated output of every unchanged top-level element.
+ */
+typedef struct BlockCache {
+    char * path;
+    Hash fingerprint;
+    // The raw contents of the cache file. Previous fragments point inside it.
+    char * contents;
+    // The blocks of the previous compilation, sorted by hash and key.
+    CachedBlock * previous;
+    size_t previousCount;
+    // The blocks of the current program, in source order.
+    CachedBlock * blocks;
+    size_t blockCount;
+} BlockCache;
+
+/** Initialize module's internal state. */
+void initializeBlockCacheModule();
+
+/** Shutdown module's internal state. */
+void shutdownBlockCacheModule();
+
+/**
+ * Loads the block cache of the specified output file. A missing, stale or
+ * corrupted cache is not an error: it just behaves as an empty one. Returns
+ * NULL (i.e., no cache) if the compiler can't be identified.
+ */
+BlockCache * loadBlockCache(const char * outputDirectory, const char * fileName);
+
+/**
+ * Serializes every top-level element of the program, and resolves which of
+ * them can be reused from the previous compilation (i.e., which have the same
+ * key as a cached one, not only the same hash).
+ */
+void planBlockCache(BlockCache * blockCache, Program * program);
+
+/**
+ * Returns the cached block at the specified top-level index, or NULL if that
+ * block is dirty (or unknown) and must be processed again.
+ */
+const CachedBlock * getCachedBlock(const BlockCache * blockCache, const size_t index);
+
+/**
+ * Stores the result of the semantic analysis of a dirty block, that accepted
+ * it with the specified number of warnings.
+ */
+void storeBlockAnalysis(BlockCache * blockCache, const size_t index, const size_t warnings);
+
+/**
+ * Stores the freshly generated fragment of a dirty block. The cache takes the
+ * ownership of the fragment.
+ */
+void storeBlockFragment(BlockCache * blockCache, const size_t index, char * fragment);
+
+/**
+ * Persists the blocks of the current program, dropping every entry that is no
+ * longer used. Returns false if the cache could not be written.
+ */
+boolean saveBlockCache(BlockCache * blockCache);
+
+/**
+ * Destroy a block cache and its resources.
+ */
+void destroyBlockCache(BlockCache * blockCache);
+
+#endif
@@ -2,10 +2,129 @@
 
 /* MODULE INTERNAL STATE */
 
-static char *_output_buffer = NULL;
-static size_t _buffer_size = 0;
-static size_t _buffer_pos = 0;
-static bool _use_buffer = false;
+/**
+ * A buffer that captures the output instead of writing it. Buffers can be
+ * nested: stopping one restores the previous.
+ */
+typedef struct OutputBuffer
+{
+    char *data;
+    size_t size;
+    size_t position;
+    struct OutputBuffer *previous;
+} OutputBuffer;
+
+/**
+ * A file that receives the output meant for an artifact.
+ */
+typedef struct
+{
+    Artifact artifact;
+    FILE *file;
+    // Length of everything written to the file.
+    size_t length;
+} OutputSink;
+
+/**
+ * The state of a generation. Every parallel task has its own, so tasks never
+ * share anything but the (read-only) AST and the romanization cache.
+ */
+typedef struct
+{
+    // The destinations of the output, when it's not captured by a buffer.
+    OutputSink *sinks;
+    size_t sinkCount;
+    // The artifacts that receive the output being generated.
+    unsigned int audience;
+    // The innermost buffer capturing the output, if any.
+    OutputBuffer *buffer;
+    // The workers available to generate independent top-level elements.
+    unsigned int jobs;
+    // The romanizations of the compilation, so a repeated word is romanized once.
+    RomanizationCache *romanizations;
+    // If any, the translations are only collected (see "_prepareRomanizations").
+    struct TranslationBatch *translations;
+    // If any, the text (but not the commands around it) is converted as it's
+    // generated: romanized, or deromanized into the script of this language.
+    const char *conversionLanguage;
+    const char *conversionScheme;
+    bool isDeromanizing;
+} GeneratorContext;
+
+/**
+ * A text to romanize (or to deromanize), collected before the generation.
+ */
+typedef struct
+{
+    const char *language;
+    const char *scheme;
+    bool isDeromanization;
+    char *input;
+} PendingTranslation;
+
+/**
+ * The translations of a program, sorted (and so grouped) by language, and the
+ * chunks in which they are romanized, each one of a single language.
+ */
+typedef struct TranslationBatch
+{
+    PendingTranslation *translations;
+    size_t count;
+    size_t capacity;
+    size_t *chunks;
+    size_t chunkCount;
+    RomanizationCache *romanizations;
+} TranslationBatch;
+
+/**
+ * The top-level elements of a parallel generation, and their fragments.
+ */
+typedef struct
+{
+    Element **elements;
+    char **fragments;
+    RomanizationCache *romanizations;
+} BlockTasks;
+
+/**
+ * The stages of a pull-based generation.
+ */
+typedef enum
+{
+    ITERATOR_PROLOGUE,
+    ITERATOR_BODY,
+    ITERATOR_EPILOGUE,
+    ITERATOR_DONE
+} OutputIteratorStage;
+
+/**
+ * A resumable walk over the top-level elements: the fragment of the current
+ * one is kept until it's completely consumed, and only then the next one is
+ * generated.
+ */
+struct OutputIterator
+{
+    GeneratorContext context;
+    OutputIteratorStage stage;
+    Content *next;
+    bool isInput;
+    char *pending;
+    size_t pendingLength;
+    size_t pendingPosition;
+};
+
+/**
+ * The result of writing a file of the output directory.
+ */
+typedef enum
+{
+    OUTPUT_FAILED,
+    OUTPUT_UNCHANGED,
+    OUTPUT_CHANGED
+} OutputFileStatus;
+
+// Every artifact built from LaTeX shares the output, unless told otherwise.
+#define DOCUMENT_AUDIENCE (ARTIFACT_DOCUMENT | ARTIFACT_WORKSHEET | ARTIFACT_ANSWER_KEY)
 
 const char _indentationCharacter = ' ';
 const char _indentationSize = 4;
@@ -26,46 +145,74 @@ void shutdownGeneratorModule()
 }
 
 /** PRIVATE FUNCTIONS */
-static void _generateProgram(Program *program);
-static void _generateContent(unsigned int indentationLevel, Content *content);
-static void _generateElement(unsigned int indentationLevel, Element *element);
-static void _generateLangtexCommand(unsigned int indentationLevel, LangtexCommand *command);
-static void _generateProgram(Program *program);
+static void _generateProgram(GeneratorContext *context, Program *program, BlockCache *blockCache);
+static void _generateContent(GeneratorContext *context, unsigned int indentationLevel, Content *content);
+static void _generateElement(GeneratorContext *context, unsigned int indentationLevel, Element *element);
+static void _generateLangtexCommand(GeneratorContext *context, unsigned int indentationLevel, LangtexCommand *command);
 static char *_indentation(const unsigned int indentationLevel);
-static void _output(const unsigned int indentationLevel, const char *const format, ...);
-static void _generatePrologue(void);
-static void _generateEpilogue();
-static void _generateContentList(unsigned int level, ContentList *contentList);
-static void _generateText(unsigned int level, Text *text);
-static void _generateParamList(unsigned int level, LangtexParamList *list);
-static void _generateParam(unsigned int level, LangtexParam *param);
-static void _generateLangtexCommandList(unsigned int level, LangtexCommandList *langtexCommandList);
+static void _output(GeneratorContext *context, const unsigned int indentationLevel, const char *const format, ...);
+static void _generatePrologue(GeneratorContext *context, const char *includeOnly);
+static void _generateEpilogue(GeneratorContext *context);
+static void _generateContentList(GeneratorContext *context, unsigned int level, ContentList *contentList);
+static void _generateText(GeneratorContext *context, unsigned int level, Text *text);
+static void _generateParamList(GeneratorContext *context, unsigned int level, LangtexParamList *list);
+static void _generateParam(GeneratorContext *context, unsigned int level, LangtexParam *param);
+static void _generateLangtexCommandList(GeneratorContext *context, unsigned int level, LangtexCommandList *langtexCommandList);
 static char *_checkTranslateParam(LangtexParamList *paramList);
 static char *_checkSpeakerParam(LangtexParamList *paramList);
-static void _generateSpeakerCommand(unsigned int level, LangtexCommand *command);
-static void _generateDialogCommand(unsigned int level, LangtexCommand *command);
-static void _generateExerciseCommand(unsigned int level, LangtexCommand *command);
-static void _generateTableCommand(unsigned int level, LangtexCommand *command);
-static void _generateRowCommand(unsigned int level, LangtexCommand *command);
-static void _generateAnswersCommand(unsigned int level, LangtexCommand *answersCommand, ContentList *optionsContentList);
-static void _generateOptionsCommand(unsigned int level,  LangtexCommand *command);
-static void _generatePromptCommand(unsigned int level, LangtexCommand *command);
-static void _generateBlockCommand(unsigned int level, LangtexCommand *command);
-static void _generateExerciseCommand(unsigned int level, LangtexCommand *command);
-static void _generateFillCommand(unsigned int level, LangtexCommand *command);
-static void _start_buffering();
-static char *_stop_buffering();
+static void _generateSpeakerCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command);
+static void _generateDialogCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command);
+static void _generateExerciseCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command);
+static void _generateTableCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command);
+static void _generateLongTable(GeneratorContext *context, unsigned int level, const char *columCs, LangtexCommandList *rows);
+static bool _isHeaderRow(LangtexCommand *command);
+static void _generateRowCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command, bool isTerminated);
+static void _generateAnswersCommand(GeneratorContext *context, unsigned int level, LangtexCommand *answersCommand, ContentList *optionsContentList);
+static void _generateOptionsCommand(GeneratorContext *context, unsigned int level,  LangtexCommand *command);
+static void _generatePromptCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command);
+static void _generateBlockCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command);
+static void _generateExerciseCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command);
+static void _generateFillCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command);
+static void _start_buffering(GeneratorContext *context);
+static char *_stop_buffering(GeneratorContext *context);
+static void _linkPreamble(const char *outputDir);
+static bool _isFileUnchanged(const char *path, const char *temporaryPath, size_t length);
+static char *_outputFilePath(const char *outputDir, const char *fileName, const char *suffix);
+static char *_artifactFilePath(const char *outputDir, const char *fileName, Artifact artifact);
+static bool _beginOutputFile(OutputSink *sink, const char *path);
+static OutputFileStatus _endOutputFile(OutputSink *sink, const char *path);
+static bool _hasSink(GeneratorContext *context, Artifact artifact);
+static void _sanitizeField(char *field);
+static void _outputFlashcard(GeneratorContext *context, LangtexCommand *command, char *front, char *romanization);
+static bool _isChapterBoundary(Element *element);
+static void _generateBlockTask(void *data, const size_t index);
+static void _generateBlocks(GeneratorContext *context, Content *first, Content *last, size_t index, BlockCache *blockCache);
+static bool _generateChapters(GeneratorContext *context, const char *outputDir, const char *fileName, bool isInput, CompilerState *compilerState);
+static void _collectTranslation(TranslationBatch *batch, PendingTranslation translation);
+static int _compareTranslations(const void *first, const void *second);
+static void _romanizeChunkTask(void *data, const size_t index);
+static void _prepareRomanizations(GeneratorContext *context, Program *program, BlockCache *blockCache);
+static void _generate(char *outputDir, char *fileName, bool isInput, bool isSplit, unsigned int jobs, unsigned int artifacts, RomanizationCache *romanizations, CompilerState *compilerState);
+static bool _advanceOutputIterator(OutputIterator *iterator);
 
 /**
  * Creates the prologue of the generated output, a Latex document that renders
- * a tree thanks to the Forest package.
+ * a tree thanks to the Forest package. If present, the "\\includeonly" list
+ * restricts which chapters are typeset.
  */
-static void _generatePrologue() {
-	_output(0, "%s\n%s\n%s\n",
+static void _generatePrologue(GeneratorContext *context, const char *includeOnly) {
+	_output(context, 0, "%s\n%s\n",
         "\\documentclass[12pt, a4paper, openany]{book}",
-		"\\input{preamble.tex}",
-        "\\begin{document}"
+		"\\input{preamble.tex}"
 	);
+	unsigned int audience = context->audience;
+	context->audience = ARTIFACT_ANSWER_KEY;
+	_output(context, 0, "%s\n", "\\answerkeytrue");
+	context->audience = audience;
+	if (includeOnly) {
+		_output(context, 0, "\\includeonly{%s}\n", includeOnly);
+	}
+	_output(context, 0, "%s\n", "\\begin{document}");
 }
 
 
@@ -74,71 +221,167 @@ static void _generatePrologue() {
  * completes a valid Latex document.
  */
 
-static void _generateEpilogue()
+static void _generateEpilogue(GeneratorContext *context)
 {
-    _output(0, "%s",
+    _output(context, 0, "%s",
             "\n\\end{document}\n");
 }
 
 /**
  * Generates the output of the program.
  */
-static void _generateProgram(Program *program)
+static void _generateProgram(GeneratorContext *context, Program *program, BlockCache *blockCache)
 {
     if (program && program->content)
     {
-        _generateContent(0, program->content);
+        _generateBlocks(context, program->content, NULL, 0, blockCache);
+    }
+}
+
+/**
+ * Generates a single top-level element in its own context, capturing it.
+ */
+static void _generateBlockTask(void *data, const size_t index)
+{
+    BlockTasks *tasks = data;
+    GeneratorContext context = {.sinks = NULL, .sinkCount = 0, .audience = DOCUMENT_AUDIENCE, .buffer = NULL, .jobs = 1, .romanizations = tasks->romanizations};
+    _start_buffering(&context);
+    _generateElement(&context, 0, tasks->elements[index]);
+    tasks->fragments[index] = _stop_buffering(&context);
+}
+
+/**
+ * Generates the top-level elements from the first one (whose index in the
+ * program is given) up to the last one, excluded. With a block cache, every
+ * clean element is spliced from it, and every dirty one is generated and
+ * captured to be cached. With more than one job, the dirty elements are
+ * generated in parallel, and then written in source order, so the output is
+ * always the same.
+ */
+static void _generateBlocks(GeneratorContext *context, Content *first, Content *last, size_t index, BlockCache *blockCache)
+{
+    if (!blockCache && context->jobs <= 1)
+    {
+        for (Content *content = first; content != last; content = content->sequenceContent)
+        {
+            _generateElement(context, 0, content->sequenceElement);
+        }
+        return;
+    }
+
+    size_t count = 0;
+    for (Content *content = first; content != last; content = content->sequenceContent)
+    {
+        ++count;
     }
+    BlockTasks tasks = {
+        .elements = calloc(count ? count : 1, sizeof(Element *)),
+        .fragments = calloc(count ? count : 1, sizeof(char *)),
+        .romanizations = context->romanizations};
+    size_t taskCount = 0;
+    size_t position = index;
+    for (Content *content = first; content != last; content = content->sequenceContent, ++position)
+    {
+        if (!getCachedBlock(blockCache, position))
+        {
+            tasks.elements[taskCount++] = content->sequenceElement;
+        }
+    }
+
+    runParallelTasks(context->jobs, taskCount, &_generateBlockTask, &tasks);
+
+    size_t task = 0;
+    position = index;
+    for (Content *content = first; content != last; content = content->sequenceContent, ++position)
+    {
+        const CachedBlock *cached = getCachedBlock(blockCache, position);
+        if (cached)
+        {
+            _output(context, 0, "%s", cached->fragment);
+            continue;
+        }
+        char *fragment = tasks.fragments[task++];
+        _output(context, 0, "%s", fragment ? fragment : "");
+        if (blockCache)
+        {
+            storeBlockFragment(blockCache, position, fragment);
+        }
+        else
+        {
+            free(fragment);
+        }
+    }
+    free(tasks.elements);
+    free(tasks.fragments);
 }
 
-static void _generateContent(unsigned int level, Content *content)
+static void _generateContent(GeneratorContext *context, unsigned int level, Content *content)
 {
     if (!content)
         return;
-    _generateElement(level, content->sequenceElement);
-    _generateContent(level, content->sequenceContent);
+    _generateElement(context, level, content->sequenceElement);
+    _generateContent(context, level, content->sequenceContent);
 }
 
-static void _generateCommand(unsigned int level, Command *command)
+static void _generateCommand(GeneratorContext *context, unsigned int level, Command *command)
 {
     if (!command)
         return;
     switch (command->type)
     {
     case PARAMETERIZED:
-        _output(level, "%s", command->parameterizedCommand);
-        _output(level, "{");
-        _generateContentList(level, command->parameterizedContentList);
-        _output(level, "}");
+        _output(context, level, "%s", command->parameterizedCommand);
+        _output(context, level, "{");
+        _generateContentList(context, level, command->parameterizedContentList);
+        _output(context, level, "}");
         break;
     case ENVIRONMENT:
-        _output(level, "\\begin{%s}", command->environmentLeftText->text);
-        _generateContentList(level, command->environmentCommandArgs);
-        _output(level, "[");
-        _generateContent(level, command->environmentParameters);
-        _output(level, "]\n");
-        _generateContent(level, command->environmentContent);
-        _output(level, "\\end{%s}\n", command->environmentLeftText->text);
+        _output(context, level, "\\begin{%s}", command->environmentLeftText->text);
+        _generateContentList(context, level, command->environmentCommandArgs);
+        _output(context, level, "[");
+        _generateContent(context, level, command->environmentParameters);
+        _output(context, level, "]\n");
+        _generateContent(context, level, command->environmentContent);
+        _output(context, level, "\\end{%s}\n", command->environmentLeftText->text);
         break;
     }
 }
 
-static void _generateText(unsigned int level, Text *text)
+static void _generateText(GeneratorContext *context, unsigned int level, Text *text)
 {
     if (!text)
         return;
-    _output(level, "%s", text->text);
+    // An escaped LaTeX character (as "\\&") is kept as it was typed.
+    if (!context->conversionLanguage || text->text[0] == '\\')
+    {
+        _output(context, level, "%s", text->text);
+    }
+    else if (context->translations)
+    {
+        _collectTranslation(context->translations, (PendingTranslation){.language = context->conversionLanguage, .scheme = context->conversionScheme, .isDeromanization = context->isDeromanizing, .input = strdup(text->text)});
+    }
+    else if (context->isDeromanizing)
+    {
+        _output(context, level, "%s", getDeromanization(context->romanizations, context->conversionLanguage, context->conversionScheme, text->text));
+    }
+    else
+    {
+        // The romanization is plain text, it may contain LaTeX special characters.
+        char *escaped = escapeLatex(getRomanization(context->romanizations, context->conversionLanguage, context->conversionScheme, text->text));
+        _output(context, level, "%s", escaped);
+        free(escaped);
+    }
 }
 
-static void _generateContentList(unsigned int level, ContentList *contentList)
+static void _generateContentList(GeneratorContext *context, unsigned int level, ContentList *contentList)
 {
     if (!contentList)
         return;
-    _generateContent(level, contentList->content);
-    _generateContentList(level, contentList->next);
+    _generateContent(context, level, contentList->content);
+    _generateContentList(context, level, contentList->next);
 }
 
-static void _generateElement(unsigned int level, Element *element)
+static void _generateElement(GeneratorContext *context, unsigned int level, Element *element)
 {
     if (!element)
         return;
@@ -146,43 +389,43 @@ static void _generateElement(unsigned int level, Element *element)
     switch (element->type)
     {
     case LANGTEX_COMMAND:
-        _generateLangtexCommand(level, element->langtexCommand);
+        _generateLangtexCommand(context, level, element->langtexCommand);
         break;
     case LATEX_COMMAND:
-        _generateCommand(level, element->command);
+        _generateCommand(context, level, element->command);
         break;
     case LATEX_TEXT:
-        _output(level, "%s", element->text->text);
+        _generateText(context, level, element->text);
         break;
     default:
         logError(_logger, "Unknown element type: %d", element->type);
     }
 }
 
-static void _generateParamList(unsigned int level, LangtexParamList *list)
+static void _generateParamList(GeneratorContext *context, unsigned int level, LangtexParamList *list)
 {
     if (list == NULL)
         return;
-    _output(level, "(");
-    _generateParam(level, list->param);
-    _generateParamList(level, list->next);
-    _output(level, ")");
+    _output(context, level, "(");
+    _generateParam(context, level, list->param);
+    _generateParamList(context, level, list->next);
+    _output(context, level, ")");
 }
 
-static void _generateParam(unsigned int level, LangtexParam *param)
+static void _generateParam(GeneratorContext *context, unsigned int level, LangtexParam *param)
 {
     if (param == NULL)
         return;
     switch (param->type)
     {
     case STRING_PARAMETER:
-        _output(level, "%s=\"%s\"", param->key, param->value.stringParam);
+        _output(context, level, "%s=\"%s\"", param->key, param->value.stringParam);
         break;
     case INTEGER_PARAMETER:
-        _output(level, "%s=%d", param->key, param->value.intParam);
+        _output(context, level, "%s=%d", param->key, param->value.intParam);
         break;
     case BOOLEAN_PARAMETER:
-        _output(level, "%s=%s", param->key, param->value.boolParam ? "true" : "false");
+        _output(context, level, "%s=%s", param->key, param->value.boolParam ? "true" : "false");
         break;
     default:
         logError(_logger, "Unknown parameter type: %d", param->type);
@@ -190,12 +433,12 @@ static void _generateParam(unsigned int level, LangtexParam *param)
     }
 }
 
-static void _generateLangtexCommandList(unsigned int level, LangtexCommandList *langtexCommandList)
+static void _generateLangtexCommandList(GeneratorContext *context, unsigned int level, LangtexCommandList *langtexCommandList)
 {
     if (langtexCommandList == NULL)
         return;
-    _generateLangtexCommand(level, langtexCommandList->command);
-    _generateLangtexCommandList(level, langtexCommandList->next);
+    _generateLangtexCommand(context, level, langtexCommandList->command);
+    _generateLangtexCommandList(context, level, langtexCommandList->next);
 }
 
 static char *_checkTranslateParam(LangtexParamList *paramList)
@@ -242,58 +485,86 @@ static char *_checkSpeakerParam(LangtexParamList *paramList)
     return name;
 }
 
-static void _generateTranslateCommand(unsigned int level, LangtexCommand *command)
+static void _generateTranslateCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command)
 {
-
-    _start_buffering();
-    _generateContent(level, command->leftText);
-    char *left_content = _stop_buffering();
     char *language = _checkTranslateParam(command->parameters);
+    // Without a scheme, the default romanization of the language is used.
+    LangtexParam *schemeParam = getParameter(command->parameters, "scheme");
+    const char *scheme = schemeParam ? schemeParam->value.stringParam : NULL;
+    // The left side may be typed romanized, and then it's its own romanization.
+    LangtexParam *inputParam = getParameter(command->parameters, "input");
+    const bool isRomanized = language && inputParam && strcmp(inputParam->value.stringParam, "roman") == 0;
+
+    // While collecting, nothing is output, but the left side must be walked.
+    unsigned int audience = context->audience;
+    context->audience = context->translations ? DOCUMENT_AUDIENCE : audience;
+    // The native side is the left side, converted into the script of the
+    // language if it's typed romanized, and the romanized side is the left
+    // side romanized (or as typed). Only the text is converted, so the LaTeX
+    // commands around it are kept in both sides.
+    context->conversionLanguage = isRomanized ? language : NULL;
+    context->conversionScheme = scheme;
+    context->isDeromanizing = true;
+    _start_buffering(context);
+    _generateContent(context, level, command->leftText);
+    char *native = _stop_buffering(context);
+    context->conversionLanguage = isRomanized ? NULL : language;
+    context->isDeromanizing = false;
+    _start_buffering(context);
+    _generateContent(context, level, command->leftText);
+    char *romanized = _stop_buffering(context);
+    context->conversionLanguage = NULL;
+    context->conversionScheme = NULL;
+    context->audience = audience;
     if (!language)
     {
         logError(_logger, "No language parameter found in translate command.");
+        free(native);
+        free(romanized);
         return;
     }
-
-    char *romanizedWord = romanize(language, left_content);
-    if (romanizedWord == NULL)
+    if (context->translations)
     {
-        logError(_logger, "Failed to romanize the word: %s", left_content);
-        free(left_content);
+        // The translation was only collected, as any nested in its right side.
+        free(native);
+        free(romanized);
+        _generateContent(context, level, command->rightText);
         return;
     }
 
-    _output(level, "\\rom[");
-    _generateContent(level, command->rightText);
-    _output(level, "]{%s}{%s}", left_content, romanizedWord);
-
-    free(romanizedWord);
-    free(left_content);
+    _output(context, level, "\\rom[");
+    _generateContent(context, level, command->rightText);
+    _output(context, level, "]{%s}{%s}", native, romanized);
+    _outputFlashcard(context, command, native, romanized);
+    free(native);
+    free(romanized);
 }
 
-static void _generateSpeakerCommand(unsigned int level, LangtexCommand *command)
+static void _generateSpeakerCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command)
 {
     if (!command)
         return;
 
     LangtexParam * speakerName = getParameter(command->parameters, "name");
-    _output(level, "\n\t\\speaker[%s]", speakerName ? speakerName->value.stringParam : "");
-    _output(level, "{");
-    _generateContent(level, command->content);
-    _output(level, "}");
+    char *name = escapeLatex(speakerName ? speakerName->value.stringParam : "");
+    _output(context, level, "\n\t\\speaker[%s]", name);
+    free(name);
+    _output(context, level, "{");
+    _generateContent(context, level, command->content);
+    _output(context, level, "}");
 }
 
-static void _generateDialogCommand(unsigned int level, LangtexCommand *command)
+static void _generateDialogCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command)
 {
     if (!command)
         return;
 
-    _output(level, "\n\\begin{dialog}");
-    _generateLangtexCommandList(level, command->langtexCommandList);
-    _output(level, "\n\\end{dialog}");
+    _output(context, level, "\n\\begin{dialog}");
+    _generateLangtexCommandList(context, level, command->langtexCommandList);
+    _output(context, level, "\n\\end{dialog}");
 }
  
-static void _generateTableCommand(unsigned int level, LangtexCommand *command)
+static void _generateTableCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command)
 {
     if (!command)
     {
@@ -301,6 +572,7 @@ static void _generateTableCommand(unsigned int level, LangtexCommand *command)
     }
 
     int cols = 0;
+    bool isLong = false;
     if (command->parameters)
     {
         LangtexParam *colsParam = getParameter(command->parameters, "cols");
@@ -308,74 +580,122 @@ static void _generateTableCommand(unsigned int level, LangtexCommand *command)
         {
             cols = colsParam->value.intParam;
         }
+        LangtexParam *longParam = getParameter(command->parameters, "long");
+        isLong = longParam != NULL && longParam->value.boolParam;
     }
 
     LangtexCommandList *current = command->langtexCommandList;
 
     // in latex: |c|c|c|c|
-    size_t maxlen = 1 + 2 * cols + 1;
-    char *columCs = malloc(maxlen);
-    columCs[0] = '|';
-    columCs[1] = '\0';
+    StringBuilder columnSpec = {0};
+    reserveStringBuilder(&columnSpec, 1 + 2 * (size_t) (cols < 0 ? 0 : cols));
+    appendCharacter(&columnSpec, '|');
     for (int i = 0; i < cols; i++)
     {
-        strcat(columCs, "c|");
+        appendStringWithLength(&columnSpec, "c|", 2);
+    }
+    char *columCs = buildString(&columnSpec);
+
+    if (isLong)
+    {
+        _generateLongTable(context, level, columCs, current);
+        free(columCs);
+        return;
     }
 
-    _output(level, "\\begin{tabular}{%s}\n", columCs);
+    _output(context, level, "\\begin{tabular}{%s}\n", columCs);
     free(columCs);
     while (current != NULL)
     {
         LangtexCommand *rowCommand = current->command; // [!row]
 
-        _generateRowCommand(level + 1, rowCommand);
+        _generateRowCommand(context, level + 1, rowCommand, false);
         current = current->next;
     }
-    _output(level, "\\end{tabular}\n");
+    _output(context, level, "\\end{tabular}\n");
+}
+
+/**
+ * Generates a table that can break across pages, for very large tables. The
+ * leading header rows are repeated at the top of every page, and LaTeX only
+ * keeps a bounded chunk of rows in memory while typesetting.
+ */
+static void _generateLongTable(GeneratorContext *context, unsigned int level, const char *columCs, LangtexCommandList *rows)
+{
+    _output(context, level, "\\begin{longtable}{%s}\n", columCs);
+    _output(context, level, "\\hline\n");
+    bool hasHeader = false;
+    while (rows != NULL && _isHeaderRow(rows->command))
+    {
+        _generateRowCommand(context, level + 1, rows->command, true);
+        rows = rows->next;
+        hasHeader = true;
+    }
+    if (hasHeader)
+    {
+        _output(context, level, "\\hline\n");
+    }
+    _output(context, level, "\\endhead\n");
+    while (rows != NULL)
+    {
+        _generateRowCommand(context, level + 1, rows->command, true);
+        rows = rows->next;
+    }
+    _output(context, level, "\\hline\n");
+    _output(context, level, "\\end{longtable}\n");
 }
 
-static void _generateRowCommand(unsigned int level, LangtexCommand *command)
+static bool _isHeaderRow(LangtexCommand *command)
+{
+    LangtexParam *param = command ? getParameter(command->parameters, "header") : NULL;
+    return param != NULL && param->value.boolParam;
+}
+
+static void _generateRowCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command, bool isTerminated)
 {
     if (!command)
     {
         return;
     }
     ContentList *current = command->contentList;
-    _output(level, "");
-    LangtexParam *param = getParameter(command->parameters, "header");
+    _output(context, level, "");
 
-    bool isHeader = param != NULL && param->value.boolParam;
+    bool isHeader = _isHeaderRow(command);
 
     while (current != NULL)
     {
         if (isHeader)
-            _output(0, "\\textbf{");
-        _generateContent(0, current->content);
+            _output(context, 0, "\\textbf{");
+        _generateContent(context, 0, current->content);
         if (isHeader)
-            _output(0, "}");
+            _output(context, 0, "}");
         current = current->next;
         if (current != NULL)
-            _output(0, " & ");
+            _output(context, 0, " & ");
+        else if (isTerminated)
+            _output(context, 0, " \\\\\n");
         else
-            _output(level, "\n");
+            _output(context, level, "\n");
     }
 }
 
-static void _generateBlockCommand(unsigned int level, LangtexCommand *command)
+static void _generateBlockCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command)
 {
     if (!command)
     {
         return;
     }
-    _output(level, "\\begin{tcolorbox}[box={%s}]\n", command->parameters ? command->parameters->param->value.stringParam : "Block");
-    _generateContent(level, command->content);
-    _output(level, "\\end{tcolorbox}");
+    char *title = escapeLatex(command->parameters ? command->parameters->param->value.stringParam : "Block");
+    _output(context, level, "\\begin{tcolorbox}[box={%s}]\n", title);
+    free(title);
+    _generateContent(context, level, command->content);
+    _output(context, level, "\\end{tcolorbox}");
 }
 
 
 // IF Prompt: ToggleExercise
 // ELSE: Exercise
-static void _generateExerciseCommand(unsigned int level, LangtexCommand *command)
+static void _generateExerciseCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command)
 {
     if (!command)
     {
@@ -383,32 +703,38 @@ static void _generateExerciseCommand(unsigned int level, LangtexCommand *command
     }
     LangtexParam *exerciseType = getParameter(command->parameters, "type");
     LangtexParam *exerciseTitle = getParameter(command->parameters, "title");
-    _output(level, "\\Exercise\n\t{");
-    _generateLangtexCommand(level, command->prompt);
-    _output(level, "}\n\t");
+    _output(context, level, "\\Exercise\n\t{");
+    _generateLangtexCommand(context, level, command->prompt);
+    _output(context, level, "}\n\t");
    
     if (command->options!=NULL){
-        _output(level, "[");
-        _generateOptionsCommand(level, command->options);
-        _output(level, "]\n\t");
+        _output(context, level, "[");
+        _generateOptionsCommand(context, level, command->options);
+        _output(context, level, "]\n\t");
     } else {
-        _output(level, "[]\n\t");
+        _output(context, level, "[]\n\t");
     }
-    _output(level, "[");
-    _generateAnswersCommand(level, command->answers, command->options ? command->options->contentList : NULL);
-    _output(level, "]\n\t[%s]", exerciseTitle ? exerciseTitle->value.stringParam : "");
+    _output(context, level, "[");
+    // The worksheet leaves the answers out, the answer key shows them.
+    unsigned int audience = context->audience;
+    context->audience &= ~ARTIFACT_WORKSHEET;
+    _generateAnswersCommand(context, level, command->answers, command->options ? command->options->contentList : NULL);
+    context->audience = audience;
+    char *title = escapeLatex(exerciseTitle ? exerciseTitle->value.stringParam : "");
+    _output(context, level, "]\n\t[%s]", title);
+    free(title);
 }
 
-static void _generatePromptCommand(unsigned int level, LangtexCommand *command)
+static void _generatePromptCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command)
 {
     if (!command)
     {
         return;
     }
-    _generateContent(level, command->content);
+    _generateContent(context, level, command->content);
 }
 
-static void _generateOptionsCommand(unsigned int level,  LangtexCommand *command)
+static void _generateOptionsCommand(GeneratorContext *context, unsigned int level,  LangtexCommand *command)
 { 
     if (!command)
     {
@@ -418,14 +744,14 @@ static void _generateOptionsCommand(unsigned int level,  LangtexCommand *command
     int count = 0;
     while (current != NULL)
     {
-        _generateContent(0, current->content);
+        _generateContent(context, 0, current->content);
         current = current->next;
         if (current != NULL)
-            _output(0, ", ");
+            _output(context, 0, ", ");
     }
 }
 
-static void _generateAnswersCommand(unsigned int level, LangtexCommand *answersCommand, ContentList *optionsContentList)
+static void _generateAnswersCommand(GeneratorContext *context, unsigned int level, LangtexCommand *answersCommand, ContentList *optionsContentList)
 {
     if (!answersCommand)
     {
@@ -434,7 +760,7 @@ static void _generateAnswersCommand(unsigned int level, LangtexCommand *answersC
     if (optionsContentList == NULL)
     {
         ContentList *current = answersCommand->contentList;
-        _generateContent(level, current->content);
+        _generateContent(context, level, current->content);
     } else {
         //multiple answers
         ContentList *currentAnswers = answersCommand->contentList;
@@ -460,9 +786,9 @@ static void _generateAnswersCommand(unsigned int level, LangtexCommand *answersC
         {
             for (int i = 0; i < count; i++){
                 if (answers[i]==iterator){
-                    _generateContent(level, optionsContentList->content);
+                    _generateContent(context, level, optionsContentList->content);
                     if (i < count - 1)
-                        _output(level, ",");
+                        _output(context, level, ",");
                     break;
                 }
             }
@@ -473,46 +799,46 @@ static void _generateAnswersCommand(unsigned int level, LangtexCommand *answersC
     }
 }
 
-static void _generateFillCommand(unsigned int level, LangtexCommand *command)
+static void _generateFillCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command)
 {
-    _output(level, "\\fillLine ");
+    _output(context, level, "\\fillLine ");
 }
 
-static void _generateLangtexCommand(unsigned int level, LangtexCommand *command)
+static void _generateLangtexCommand(GeneratorContext *context, unsigned int level, LangtexCommand *command)
 {
     if (!command)
         return;
     switch (command->type)
     {
     case LANGTEX_TRANSLATE:
-        _generateTranslateCommand(level, command);
+        _generateTranslateCommand(context, level, command);
         break;
     case LANGTEX_DIALOG:
-        _generateDialogCommand(level, command);
+        _generateDialogCommand(context, level, command);
         break;
     case LANGTEX_SPEAKER:
-        _generateSpeakerCommand(level, command);
+        _generateSpeakerCommand(context, level, command);
         break;
     case LANGTEX_EXERCISE:
-        _generateExerciseCommand(level, command);
+        _generateExerciseCommand(context, level, command);
         break;
     case LANGTEX_TABLE:
-        _generateTableCommand(level, command);
+        _generateTableCommand(context, level, command);
         break;
     case LANGTEX_ROW:
-        _generateRowCommand(level, command);
+        _generateRowCommand(context, level, command, false);
         break;
     case LANGTEX_BLOCK:
-        _generateBlockCommand(level, command);
+        _generateBlockCommand(context, level, command);
         break;
     case LANGTEX_PROMPT:
-        _generatePromptCommand(level, command);
+        _generatePromptCommand(context, level, command);
         break;
     case LANGTEX_FILL:
-        _generateFillCommand(level, command);
+        _generateFillCommand(context, level, command);
         break;
     default:
-        _output(level, "%% Unsupported command type: %d\\n", command->type);
+        _output(context, level, "%% Unsupported command type: %d\\n", command->type);
     }
 }
 
@@ -544,36 +870,44 @@ static char *_indentation(const unsigned int level)
  * buffering.
  */
 // Funciones para manejar el buffer
-static void _start_buffering()
+static void _start_buffering(GeneratorContext *context)
 {
-    _buffer_size = 2048;
-    _output_buffer = malloc(_buffer_size);
-    _buffer_pos = 0;
-    _use_buffer = true;
-    if (_output_buffer)
+    OutputBuffer *buffer = calloc(1, sizeof(OutputBuffer));
+    buffer->size = 2048;
+    buffer->data = malloc(buffer->size);
+    if (buffer->data)
     {
-        _output_buffer[0] = '\0';
+        buffer->data[0] = '\0';
     }
+    buffer->previous = context->buffer;
+    context->buffer = buffer;
 }
 
-static char *_stop_buffering()
+static char *_stop_buffering(GeneratorContext *context)
 {
-    _use_buffer = false;
-    char *result = _output_buffer;
-    _output_buffer = NULL;
-    _buffer_size = 0;
-    _buffer_pos = 0;
+    OutputBuffer *buffer = context->buffer;
+    if (!buffer)
+        return NULL;
+    char *result = buffer->data;
+    context->buffer = buffer->previous;
+    free(buffer);
     return result;
 }
 
 // Version modificada de _output que admite modo buffer
-static void _output(const unsigned int indentationLevel, const char *const format, ...)
+static void _output(GeneratorContext *context, const unsigned int indentationLevel, const char *const format, ...)
 {
+    if (context->buffer && !(context->audience & ARTIFACT_DOCUMENT))
+    {
+        // A buffer always ends up in the document.
+        return;
+    }
     va_list arguments;
     va_start(arguments, format);
 
-    if (_use_buffer && _output_buffer)
+    if (context->buffer && context->buffer->data)
     {
+        OutputBuffer *buffer = context->buffer;
         char *indentation = _indentation(indentationLevel);
         char *effectiveFormat = concatenate(2, indentation, format);
 
@@ -582,21 +916,21 @@ static void _output(const unsigned int indentationLevel, const char *const forma
         int needed_chars = vsnprintf(NULL, 0, effectiveFormat, args_copy);
         va_end(args_copy);
 
-        size_t needed_size = _buffer_pos + needed_chars + 1;
-        if (needed_size > _buffer_size)
+        size_t needed_size = buffer->position + needed_chars + 1;
+        if (needed_size > buffer->size)
         {
-            _buffer_size = needed_size * 2;
-            char *new_buffer = realloc(_output_buffer, _buffer_size);
+            char *new_buffer = realloc(buffer->data, needed_size * 2);
             if (new_buffer)
             {
-                _output_buffer = new_buffer;
+                buffer->data = new_buffer;
+                buffer->size = needed_size * 2;
             }
         }
 
-        if (_output_buffer)
+        if (needed_size <= buffer->size)
         {
-            vsprintf(_output_buffer + _buffer_pos, effectiveFormat, arguments);
-            _buffer_pos += needed_chars;
+            vsprintf(buffer->data + buffer->position, effectiveFormat, arguments);
+            buffer->position += needed_chars;
         }
 
         free(effectiveFormat);
@@ -607,8 +941,26 @@ static void _output(const unsigned int indentationLevel, const char *const forma
         // Modo normal: el codigo og del profe
         char *indentation = _indentation(indentationLevel);
         char *effectiveFormat = concatenate(2, indentation, format);
-        vfprintf(stdout, effectiveFormat, arguments);
-        fflush(stdout);
+        va_list args_copy;
+        va_copy(args_copy, arguments);
+        int length = vsnprintf(NULL, 0, effectiveFormat, args_copy);
+        va_end(args_copy);
+        char *text = 0 <= length ? malloc(length + 1) : NULL;
+        if (text)
+        {
+            vsnprintf(text, length + 1, effectiveFormat, arguments);
+        }
+        for (size_t k = 0; text && k < context->sinkCount; ++k)
+        {
+            OutputSink *sink = &context->sinks[k];
+            if (sink->file && (sink->artifact & context->audience))
+            {
+                fwrite(text, 1, length, sink->file);
+                sink->length += length;
+                fflush(sink->file);
+            }
+        }
+        free(text);
         free(effectiveFormat);
         free(indentation);
     }
@@ -616,79 +968,614 @@ static void _output(const unsigned int indentationLevel, const char *const forma
     va_end(arguments);
 }
 
-/** PUBLIC FUNCTIONS */
+/**
+ * Links the preamble inside the output directory. An existing link with the
+ * right target is left untouched, so its timestamp doesn't trigger rebuilds.
+ */
+static void _linkPreamble(const char *outputDir)
+{
+    const char *preambleSource = "../references/preamble.tex";
+    char *preambleLinkPath = malloc(strlen(outputDir) + strlen("/preamble.tex") + 1);
+    sprintf(preambleLinkPath, "%s/preamble.tex", outputDir);
+
+    char target[4096];
+    ssize_t length = readlink(preambleLinkPath, target, sizeof(target) - 1);
+    if (0 <= length)
+    {
+        target[length] = '\0';
+    }
+    if (0 <= length && strcmp(target, preambleSource) == 0)
+    {
+        logDebugging(_logger, "Preamble symlink is up to date: %s -> %s", preambleLinkPath, preambleSource);
+    }
+    else
+    {
+        unlink(preambleLinkPath);
+        if (symlink(preambleSource, preambleLinkPath) == -1) {
+            logError(_logger, "Failed to create preamble symlink: %s -> %s", preambleLinkPath, preambleSource);
+        } else {
+            logDebugging(_logger, "Created preamble symlink: %s -> %s", preambleLinkPath, preambleSource);
+        }
+    }
+    free(preambleLinkPath);
+}
+
+/**
+ * Returns true if the file exists and has exactly the content of the temporary
+ * one, of the specified length. Files of another length are told apart without
+ * reading them, and otherwise both are streamed, never loaded entirely in
+ * memory.
+ */
+static bool _isFileUnchanged(const char *path, const char *temporaryPath, size_t length)
+{
+    struct stat status;
+    if (stat(path, &status) != 0 || (size_t) status.st_size != length)
+    {
+        return false;
+    }
+    FILE *file = fopen(path, "rb");
+    FILE *temporaryFile = fopen(temporaryPath, "rb");
+    bool isUnchanged = file != NULL && temporaryFile != NULL;
+    char chunk[16384];
+    char temporaryChunk[sizeof(chunk)];
+    size_t read = 0;
+    while (isUnchanged && (read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        isUnchanged = fread(temporaryChunk, 1, read, temporaryFile) == read && memcmp(chunk, temporaryChunk, read) == 0;
+    }
+    // Both must end at once (the file may have changed since its size was read).
+    isUnchanged = isUnchanged && ferror(file) == 0 && fread(temporaryChunk, 1, 1, temporaryFile) == 0 && feof(file);
+    if (file)
+        fclose(file);
+    if (temporaryFile)
+        fclose(temporaryFile);
+    return isUnchanged;
+}
+
+/**
+ * Builds the path of a file inside the output directory. The suffix is
+ * inserted before the ".tex" extension of the file name, if any.
+ */
+static char *_outputFilePath(const char *outputDir, const char *fileName, const char *suffix)
+{
+    size_t len = strlen(outputDir);
+    bool needs_slash = (len > 0 && outputDir[len - 1] != '/');
+    size_t nameLength = strlen(fileName);
+    size_t baseLength = nameLength;
+    if (4 <= nameLength && strcmp(fileName + nameLength - 4, ".tex") == 0) {
+        baseLength -= 4;
+    }
+    char *outputPath = malloc(len + nameLength + strlen(suffix) + 2);
+    sprintf(outputPath, "%s%s%.*s%s%s", outputDir, needs_slash ? "/" : "", (int) baseLength, fileName, suffix, fileName + baseLength);
+    return outputPath;
+}
+
+/**
+ * Builds the path of the file of an artifact inside the output directory.
+ * Flashcards are tab-separated values instead of LaTeX.
+ */
+static char *_artifactFilePath(const char *outputDir, const char *fileName, Artifact artifact)
+{
+    switch (artifact)
+    {
+    case ARTIFACT_WORKSHEET:
+        return _outputFilePath(outputDir, fileName, "-worksheet");
+    case ARTIFACT_ANSWER_KEY:
+        return _outputFilePath(outputDir, fileName, "-answers");
+    case ARTIFACT_FLASHCARDS:
+    {
+        char *path = _outputFilePath(outputDir, fileName, "-flashcards");
+        size_t length = strlen(path);
+        if (4 <= length && strcmp(path + length - 4, ".tex") == 0)
+        {
+            strcpy(path + length - 4, ".tsv");
+            return path;
+        }
+        char *tsvPath = concatenate(2, path, ".tsv");
+        free(path);
+        return tsvPath;
+    }
+    default:
+        return _outputFilePath(outputDir, fileName, "");
+    }
+}
+
+/**
+ * Redirects the output of the sink to a temporary file next to the specified
+ * path.
+ */
+static bool _beginOutputFile(OutputSink *sink, const char *path)
+{
+    // The output is written aside, and only replaces the file if it changed.
+    char *temporaryPath = concatenate(2, path, ".tmp");
+    FILE *fd = fopen(temporaryPath, "w");
+    free(temporaryPath);
+    if (fd == NULL) {
+        logError(_logger, "Could not create/open file: %s.tmp", path);
+        return false;
+    }
+    sink->file = fd;
+    sink->length = 0;
+    return true;
+}
+
+/**
+ * Restores the output, and replaces the file with the temporary one only if
+ * its content changed, so an identical output keeps its timestamp.
+ */
+static OutputFileStatus _endOutputFile(OutputSink *sink, const char *path)
+{
+    FILE *fd = sink->file;
+    sink->file = NULL;
+
+    char *temporaryPath = concatenate(2, path, ".tmp");
+    OutputFileStatus status = OUTPUT_CHANGED;
+    if (fclose(fd) != 0) {
+        logError(_logger, "Error while closing file");
+        status = OUTPUT_FAILED;
+    } else if (_isFileUnchanged(path, temporaryPath, sink->length)) {
+        logDebugging(_logger, "Output is unchanged, keeping file: %s", path);
+        status = OUTPUT_UNCHANGED;
+    } else if (rename(temporaryPath, path) != 0) {
+        logError(_logger, "Could not replace file: %s", path);
+        status = OUTPUT_FAILED;
+    }
+    if (status != OUTPUT_CHANGED) {
+        remove(temporaryPath);
+    }
+    free(temporaryPath);
+    return status;
+}
+
+/**
+ * Returns true if some sink of the context receives the artifact.
+ */
+static bool _hasSink(GeneratorContext *context, Artifact artifact)
+{
+    for (size_t k = 0; k < context->sinkCount; ++k)
+    {
+        if (context->sinks[k].artifact == artifact && context->sinks[k].file)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Replaces the tabs and line breaks of a field of the flashcards, which would
+ * break its row.
+ */
+static void _sanitizeField(char *field)
+{
+    for (char *c = field; c && *c; ++c)
+    {
+        if (*c == '\t' || *c == '\n' || *c == '\r')
+            *c = ' ';
+    }
+}
+
+/**
+ * Exports a translation as a row of the flashcards: the original text, its
+ * translation and its romanization, as the LaTeX that the document typesets
+ * (the fields are sanitized in place). A translation captured by a buffer is
+ * already part of an enclosing one, so it's not exported on its own.
+ */
+static void _outputFlashcard(GeneratorContext *context, LangtexCommand *command, char *front, char *romanization)
+{
+    if (context->buffer || !_hasSink(context, ARTIFACT_FLASHCARDS))
+        return;
+    _start_buffering(context);
+    _generateContent(context, 0, command->rightText);
+    char *back = _stop_buffering(context);
+    _sanitizeField(front);
+    _sanitizeField(back);
+    _sanitizeField(romanization);
+
+    unsigned int audience = context->audience;
+    context->audience = ARTIFACT_FLASHCARDS;
+    _output(context, 0, "%s\t%s\t%s\n", front, back ? back : "", romanization);
+    context->audience = audience;
+    free(back);
+}
+
+/**
+ * A top-level sectioning command starts a new chapter in split mode.
+ */
+static bool _isChapterBoundary(Element *element)
+{
+    if (!element || element->type != LATEX_COMMAND || element->command->type != PARAMETERIZED)
+        return false;
+    const char *name = element->command->parameterizedCommand;
+    return strcmp(name, "\\part") == 0 || strcmp(name, "\\chapter") == 0 || strcmp(name, "\\section") == 0;
+}
 
-void generate(char * outputDir, char * fileName, bool isInput, CompilerState *compilerState)
+/**
+ * Generates every chapter in its own file, and a main document that includes
+ * them all. When only some chapters changed, the main document restricts the
+ * next LaTeX run to them with "\\includeonly". If nothing changed at all, the
+ * main document is not touched.
+ */
+static bool _generateChapters(GeneratorContext *context, const char *outputDir, const char *fileName, bool isInput, CompilerState *compilerState)
 {
-    char* outputPath = NULL;
-    FILE *original_stdout = NULL;
+    Program *program = compilerState->abstractSyntaxtTree;
+    Content *start = program ? program->content : NULL;
+    size_t index = 0;
+    size_t chapters = 0;
+    size_t changedChapters = 0;
+    bool *changed = NULL;
+
+    while (start != NULL) {
+        Content *end = start->sequenceContent;
+        size_t count = 1;
+        while (end != NULL && !_isChapterBoundary(end->sequenceElement)) {
+            end = end->sequenceContent;
+            ++count;
+        }
+
+        char suffix[32];
+        sprintf(suffix, "-%02zu", ++chapters);
+        char *chapterPath = _outputFilePath(outputDir, fileName, suffix);
+        if (!_beginOutputFile(&context->sinks[0], chapterPath)) {
+            free(chapterPath);
+            free(changed);
+            return false;
+        }
+        _generateBlocks(context, start, end, index, compilerState->blockCache);
+        OutputFileStatus status = _endOutputFile(&context->sinks[0], chapterPath);
+        free(chapterPath);
+        if (status == OUTPUT_FAILED) {
+            free(changed);
+            return false;
+        }
+
+        changed = realloc(changed, chapters * sizeof(bool));
+        changed[chapters - 1] = status == OUTPUT_CHANGED;
+        changedChapters += status == OUTPUT_CHANGED;
+        index += count;
+        start = end;
+    }
+
+    // Chapters left behind by a longer version of the document.
+    bool removedChapters = false;
+    for (size_t chapter = chapters + 1;; ++chapter) {
+        char suffix[32];
+        sprintf(suffix, "-%02zu", chapter);
+        char *chapterPath = _outputFilePath(outputDir, fileName, suffix);
+        bool removed = remove(chapterPath) == 0;
+        free(chapterPath);
+        if (!removed)
+            break;
+        removedChapters = true;
+    }
+
+    char *outputPath = _outputFilePath(outputDir, fileName, "");
+    struct stat st = {0};
+    if (changedChapters == 0 && !removedChapters && stat(outputPath, &st) == 0) {
+        logDebugging(_logger, "No chapter changed, keeping file: %s", outputPath);
+        free(outputPath);
+        free(changed);
+        return true;
+    }
 
-    if (outputDir != NULL) {
-        // CREATE DIRECTORY IF IT DOESN'T EXIST
-        struct stat st = {0};
-        if (stat(outputDir, &st) == -1) {
-            if (mkdir(outputDir, 0755) == -1) {
-                logError(_logger, "Could not create directory: %s", outputDir);
-                return;
+    char *baseName = strdup(fileName);
+    size_t baseLength = strlen(baseName);
+    if (4 <= baseLength && strcmp(baseName + baseLength - 4, ".tex") == 0) {
+        baseName[baseLength - 4] = '\0';
+    }
+    char *includeOnly = NULL;
+    if (0 < changedChapters && changedChapters < chapters) {
+        includeOnly = calloc(changedChapters * (strlen(baseName) + 24) + 1, sizeof(char));
+        char *cursor = includeOnly;
+        for (size_t chapter = 0; chapter < chapters; ++chapter) {
+            if (changed[chapter]) {
+                cursor += sprintf(cursor, "%s%s-%02zu", cursor == includeOnly ? "" : ",", baseName, chapter + 1);
             }
-            logDebugging(_logger, "Created directory: %s", outputDir);
         }
+    }
 
-        // Create symlink to preamble.tex
+    bool succeed = _beginOutputFile(&context->sinks[0], outputPath);
+    if (succeed) {
+        logDebugging(_logger, "Generating LaNgTeX chapters driver to file: %s", outputPath);
+        if (!isInput) _generatePrologue(context, includeOnly);
+        for (size_t chapter = 0; chapter < chapters; ++chapter) {
+            _output(context, 0, "\\include{%s-%02zu}\n", baseName, chapter + 1);
+        }
+        if (!isInput) _generateEpilogue(context);
+        succeed = _endOutputFile(&context->sinks[0], outputPath) != OUTPUT_FAILED;
+    }
+    free(includeOnly);
+    free(baseName);
+    free(outputPath);
+    free(changed);
+    return succeed;
+}
 
-        char* preambleLinkPath = malloc(strlen(outputDir) + strlen("/preamble.tex") + 1);
-        sprintf(preambleLinkPath, "%s/preamble.tex", outputDir);
+/**
+ * Generates the next fragment of the iterator, that is, the prologue, a
+ * top-level element or the epilogue. Returns false if there's nothing left.
+ */
+static bool _advanceOutputIterator(OutputIterator *iterator)
+{
+    free(iterator->pending);
+    iterator->pending = NULL;
+    iterator->pendingLength = 0;
+    iterator->pendingPosition = 0;
+
+    GeneratorContext *context = &iterator->context;
+    _start_buffering(context);
+    switch (iterator->stage)
+    {
+    case ITERATOR_PROLOGUE:
+        if (!iterator->isInput) _generatePrologue(context, NULL);
+        iterator->stage = ITERATOR_BODY;
+        break;
+    case ITERATOR_BODY:
+        if (iterator->next == NULL)
+        {
+            if (!iterator->isInput) _generateEpilogue(context);
+            iterator->stage = ITERATOR_DONE;
+            break;
+        }
+        _generateElement(context, 0, iterator->next->sequenceElement);
+        iterator->next = iterator->next->sequenceContent;
+        break;
+    default:
+        iterator->stage = ITERATOR_DONE;
+        break;
+    }
+    iterator->pending = _stop_buffering(context);
+    iterator->pendingLength = iterator->pending ? strlen(iterator->pending) : 0;
+    return iterator->pending != NULL || iterator->stage != ITERATOR_DONE;
+}
 
-        unlink(preambleLinkPath);
+static void _collectTranslation(TranslationBatch *batch, PendingTranslation translation)
+{
+    if (batch->count == batch->capacity)
+    {
+        batch->capacity = batch->capacity ? 2 * batch->capacity : 64;
+        batch->translations = realloc(batch->translations, batch->capacity * sizeof(PendingTranslation));
+    }
+    batch->translations[batch->count++] = translation;
+}
 
-        const char* preambleSource = "../references/preamble.tex";
-        if (symlink(preambleSource, preambleLinkPath) == -1) {
-            logError(_logger, "Failed to create preamble symlink: %s -> %s", preambleLinkPath, preambleSource);
-        } else {
-            logDebugging(_logger, "Created preamble symlink: %s -> %s", preambleLinkPath, preambleSource);
+static int _compareTranslations(const void *first, const void *second)
+{
+    const PendingTranslation *a = first;
+    const PendingTranslation *b = second;
+    const int language = strcmp(a->language, b->language);
+    if (language != 0)
+    {
+        return language;
+    }
+    const int scheme = strcmp(a->scheme ? a->scheme : "", b->scheme ? b->scheme : "");
+    if (scheme != 0)
+    {
+        return scheme;
+    }
+    if (a->isDeromanization != b->isDeromanization)
+    {
+        return a->isDeromanization ? 1 : -1;
+    }
+    return strcmp(a->input, b->input);
+}
+
+static void _romanizeChunkTask(void *data, const size_t index)
+{
+    TranslationBatch *batch = data;
+    for (size_t k = batch->chunks[index]; k < batch->chunks[index + 1]; ++k)
+    {
+        const PendingTranslation *translation = &batch->translations[k];
+        if (translation->isDeromanization)
+        {
+            getDeromanization(batch->romanizations, translation->language, translation->scheme, translation->input);
+        }
+        else
+        {
+            getRomanization(batch->romanizations, translation->language, translation->scheme, translation->input);
         }
-        
-        free(preambleLinkPath);
+    }
+}
 
-        size_t len = strlen(outputDir);
-        bool needs_slash = (len > 0 && outputDir[len - 1] != '/');
-        outputPath = malloc(strlen(outputDir) + strlen(fileName) + 2);
+/**
+ * Fills the romanization cache before the generation, so it only has to look
+ * the romanizations up. The program is walked once without output, to collect
+ * every text in the left side of every translation (as it will be converted),
+ * but the ones in the blocks that are spliced from the block cache. Then,
+ * every distinct one is romanized, grouped by language, in chunks that run in
+ * parallel. With a single job, nothing is prepared, since the generation fills
+ * the cache as it goes, and that second walk would only add to it.
+ */
+static void _prepareRomanizations(GeneratorContext *context, Program *program, BlockCache *blockCache)
+{
+    if (context->jobs <= 1)
+    {
+        return;
+    }
+    // Large enough to amortize a task, and small enough to balance the workers.
+    const size_t chunkSize = 256;
+    TranslationBatch batch = {.romanizations = context->romanizations};
+    GeneratorContext collector = {.sinks = NULL, .sinkCount = 0, .audience = 0, .buffer = NULL, .jobs = 1, .romanizations = context->romanizations, .translations = &batch};
+    _start_buffering(&collector);
+    size_t index = 0;
+    for (Content *content = program ? program->content : NULL; content; content = content->sequenceContent, ++index)
+    {
+        if (!getCachedBlock(blockCache, index))
+        {
+            _generateElement(&collector, 0, content->sequenceElement);
+        }
+    }
+    free(_stop_buffering(&collector));
 
-        if (outputPath == NULL) {
-            logError(_logger, "Memory allocation failed for outputPath.");
-            return;
+    qsort(batch.translations, batch.count, sizeof(PendingTranslation), _compareTranslations);
+    size_t unique = 0;
+    batch.chunks = malloc((batch.count + 1) * sizeof(size_t));
+    for (size_t k = 0; k < batch.count; ++k)
+    {
+        PendingTranslation translation = batch.translations[k];
+        if (unique != 0 && _compareTranslations(&batch.translations[unique - 1], &translation) == 0)
+        {
+            free(translation.input);
+            continue;
+        }
+        if (unique == 0 || strcmp(batch.translations[unique - 1].language, translation.language) != 0 || unique - batch.chunks[batch.chunkCount - 1] == chunkSize)
+        {
+            batch.chunks[batch.chunkCount++] = unique;
         }
-        sprintf(outputPath, "%s%s%s", outputDir, needs_slash ? "/" : "", fileName);
+        batch.translations[unique++] = translation;
+    }
+    batch.chunks[batch.chunkCount] = unique;
+    logDebugging(_logger, "Romanizing %zu distinct translations (of %zu) in %zu chunks.", unique, batch.count, batch.chunkCount);
+    runParallelTasks(context->jobs, batch.chunkCount, &_romanizeChunkTask, &batch);
 
-        FILE *fd = fopen(outputPath, "w");
-        if (fd == NULL) {
-            logError(_logger, "Could not create/open file: %s", outputPath);
-            free(outputPath);
-            return;
+    for (size_t k = 0; k < unique; ++k)
+    {
+        free(batch.translations[k].input);
+    }
+    free(batch.translations);
+    free(batch.chunks);
+}
+
+/**
+ * Generates the output of the compilation (see "generate"), with the specified
+ * romanization cache.
+ */
+static void _generate(char *outputDir, char *fileName, bool isInput, bool isSplit, unsigned int jobs, unsigned int artifacts, RomanizationCache *romanizations, CompilerState *compilerState)
+{
+    OutputSink sinks[] = {
+        {.artifact = ARTIFACT_DOCUMENT, .file = stdout, .length = 0},
+        {.artifact = ARTIFACT_WORKSHEET, .file = NULL, .length = 0},
+        {.artifact = ARTIFACT_ANSWER_KEY, .file = NULL, .length = 0},
+        {.artifact = ARTIFACT_FLASHCARDS, .file = NULL, .length = 0}};
+    GeneratorContext context = {.sinks = sinks, .sinkCount = 1, .audience = DOCUMENT_AUDIENCE, .buffer = NULL, .jobs = jobs, .romanizations = romanizations};
+    artifacts &= ~ARTIFACT_DOCUMENT;
+    if (artifacts && (outputDir == NULL || isSplit)) {
+        logWarning(_logger, "Additional artifacts require an output directory and no split mode, generating only the document.");
+        artifacts = 0;
+    }
+    _prepareRomanizations(&context, compilerState->abstractSyntaxtTree, artifacts ? NULL : compilerState->blockCache);
+    if (outputDir == NULL) {
+        if (isSplit) {
+            logWarning(_logger, "Split output requires an output directory, generating a single document.");
         }
-        
-        logDebugging(_logger, "Generating LaNgTeX output to file: %s", outputPath);
-        
-        original_stdout = stdout;
-        stdout = fd;
-    } else {
         logDebugging(_logger, "Generating LaNgTeX output to stdout");
+        if (!isInput) _generatePrologue(&context, NULL);
+        _generateProgram(&context, compilerState->abstractSyntaxtTree, compilerState->blockCache);
+        if (!isInput) _generateEpilogue(&context);
+        logDebugging(_logger, "Generation is done.");
+        return;
+    }
+
+    // CREATE DIRECTORY IF IT DOESN'T EXIST
+    struct stat st = {0};
+    if (stat(outputDir, &st) == -1) {
+        if (mkdir(outputDir, 0755) == -1) {
+            logError(_logger, "Could not create directory: %s", outputDir);
+            return;
+        }
+        logDebugging(_logger, "Created directory: %s", outputDir);
     }
 
-    if (!isInput) _generatePrologue();
-    _generateProgram(compilerState->abstractSyntaxtTree);
-    if (!isInput) _generateEpilogue();
+    // Create symlink to preamble.tex
+    _linkPreamble(outputDir);
 
-    if (outputDir != NULL && original_stdout != NULL) {
-        FILE *fd = stdout;
-        stdout = original_stdout;
-        
-        if (fclose(fd) != 0) {
-            logError(_logger, "Error while closing file");
+    bool succeed = false;
+    if (isSplit) {
+        succeed = _generateChapters(&context, outputDir, fileName, isInput, compilerState);
+    } else {
+        // Every artifact is emitted in the same traversal, each one by its own
+        // sink. Cached and parallel blocks are captured as plain document
+        // fragments, so they are only used for the document alone.
+        BlockCache *blockCache = artifacts ? NULL : compilerState->blockCache;
+        if (artifacts) {
+            context.jobs = 1;
+        }
+        char *paths[sizeof(sinks) / sizeof(OutputSink)] = {NULL};
+        succeed = true;
+        context.sinkCount = 0;
+        for (size_t k = 0; k < sizeof(sinks) / sizeof(OutputSink); ++k) {
+            if (k != 0 && !(artifacts & sinks[k].artifact)) {
+                continue;
+            }
+            sinks[context.sinkCount] = sinks[k];
+            paths[context.sinkCount] = _artifactFilePath(outputDir, fileName, sinks[k].artifact);
+            succeed = succeed && _beginOutputFile(&sinks[context.sinkCount], paths[context.sinkCount]);
+            ++context.sinkCount;
+        }
+        if (succeed) {
+            logDebugging(_logger, "Generating LaNgTeX output to file: %s", paths[0]);
+            if (!isInput) _generatePrologue(&context, NULL);
+            _generateProgram(&context, compilerState->abstractSyntaxtTree, blockCache);
+            if (!isInput) _generateEpilogue(&context);
+        }
+        for (size_t k = 0; k < context.sinkCount; ++k) {
+            if (sinks[k].file == NULL) {
+                succeed = false;
+            } else if (succeed) {
+                succeed = _endOutputFile(&sinks[k], paths[k]) != OUTPUT_FAILED;
+            } else {
+                char *temporaryPath = concatenate(2, paths[k], ".tmp");
+                fclose(sinks[k].file);
+                remove(temporaryPath);
+                free(temporaryPath);
+            }
+            free(paths[k]);
         }
     }
 
+    // With artifacts, the block cache was not used, so it would be incomplete.
+    if (succeed && !artifacts) {
+        saveBlockCache(compilerState->blockCache);
+    }
     logDebugging(_logger, "Generation is done.");
-    free(outputPath);
+}
 
+/** PUBLIC FUNCTIONS */
+
+void generate(char * outputDir, char * fileName, bool isInput, bool isSplit, unsigned int jobs, unsigned int artifacts, CompilerState *compilerState)
+{
+    RomanizationCache *romanizations = createRomanizationCache();
+    _generate(outputDir, fileName, isInput, isSplit, jobs, artifacts, romanizations, compilerState);
+    logRomanizationCacheStatistics(romanizations);
+    destroyRomanizationCache(romanizations);
+}
+
+OutputIterator *createOutputIterator(CompilerState *compilerState, bool isInput)
+{
+    OutputIterator *iterator = calloc(1, sizeof(OutputIterator));
+    iterator->context = (GeneratorContext){.sinks = NULL, .sinkCount = 0, .audience = DOCUMENT_AUDIENCE, .buffer = NULL, .jobs = 1, .romanizations = createRomanizationCache()};
+    iterator->stage = ITERATOR_PROLOGUE;
+    Program *program = compilerState->abstractSyntaxtTree;
+    iterator->next = program ? program->content : NULL;
+    iterator->isInput = isInput;
+    return iterator;
+}
+
+size_t nextOutputChunk(OutputIterator *iterator, char *buffer, const size_t capacity)
+{
+    size_t copied = 0;
+    while (copied < capacity)
+    {
+        if (iterator->pendingPosition == iterator->pendingLength)
+        {
+            if (iterator->stage == ITERATOR_DONE || !_advanceOutputIterator(iterator))
+                break;
+            continue;
+        }
+        size_t available = iterator->pendingLength - iterator->pendingPosition;
+        size_t length = available < capacity - copied ? available : capacity - copied;
+        memcpy(buffer + copied, iterator->pending + iterator->pendingPosition, length);
+        iterator->pendingPosition += length;
+        copied += length;
+    }
+    return copied;
+}
+
+void destroyOutputIterator(OutputIterator *iterator)
+{
+    if (iterator != NULL)
+    {
+        logRomanizationCacheStatistics(iterator->context.romanizations);
+        destroyRomanizationCache(iterator->context.romanizations);
+        free(iterator->pending);
+        free(iterator);
+    }
 }
@@ -2,12 +2,15 @@
 #define GENERATOR_HEADER
 
 #include "../romanizers/romanize.h"
+#include "../romanizers/RomanizationCache.h"
 // TODO is this ok?
 // #include "../../../../references/preamble.tex"
 #include "../../frontend/syntactic-analysis/LangTeXAST.h"
 #include "../../shared/CompilerState.h"
 #include "../../shared/Logger.h"
 #include "../../shared/String.h"
+#include "../../shared/WorkStealingPool.h"
+#include "BlockCache.h"
 #include <stdarg.h>
 #include <stdio.h>
 #include <wchar.h>
@@ -16,6 +19,26 @@
 #include <sys/stat.h>
 #include <errno.h>
 
+/**
+ * The artifacts that a single generation can emit, as flags. The document is
+ * always emitted; the worksheet leaves the answers of the exercises out, the
+ * answer key shows them, and the flashcards are a tab-separated file with a
+ * row per translation.
+ */
+typedef enum
+{
+    ARTIFACT_DOCUMENT = 1 << 0,
+    ARTIFACT_WORKSHEET = 1 << 1,
+    ARTIFACT_ANSWER_KEY = 1 << 2,
+    ARTIFACT_FLASHCARDS = 1 << 3
+} Artifact;
+
+/**
+ * A pull-based generation of the output, that produces it chunk by chunk. At
+ * most one top-level element is kept in memory at any time.
+ */
+typedef struct OutputIterator OutputIterator;
+
 /** Initialize module's internal state. */
 void initializeGeneratorModule();
 
@@ -23,8 +46,28 @@ void initializeGeneratorModule();
 void shutdownGeneratorModule();
 
 /**
- * Generates the final output using the current compiler state.
+ * Generates the final output using the current compiler state. In split mode
+ * (that requires an output directory), every chapter is written in its own
+ * file, and the main file only includes them. With more than one job, the
+ * top-level elements are generated in parallel, but written in order. Every
+ * additional artifact is emitted by the same traversal, next to the document.
  */
-void generate(char * outputPath, char * fileName, bool isInput, CompilerState *compilerState);
+void generate(char * outputPath, char * fileName, bool isInput, bool isSplit, unsigned int jobs, unsigned int artifacts, CompilerState *compilerState);
+
+/**
+ * Starts a pull-based generation of the program of the compiler state, that
+ * must outlive the iterator.
+ */
+OutputIterator * createOutputIterator(CompilerState * compilerState, bool isInput);
+
+/**
+ * Writes the next chunk of the output, of at most "capacity" bytes, in the
+ * buffer (without a null terminator). Returns the length of the chunk, which
+ * is only 0 once the whole output was produced.
+ */
+size_t nextOutputChunk(OutputIterator * iterator, char * buffer, const size_t capacity);
+
+/** Releases the iterator, even if the output wasn't completely consumed. */
+void destroyOutputIterator(OutputIterator * iterator);
 
 #endif
@@ -0,0 +1,415 @@
+#include "HtmlGenerator.h"
+
+/* MODULE INTERNAL STATE */
+
+static Logger *_logger = NULL;
+
+/**
+ * The state of a preview being generated: the file it's written to, and the
+ * romanizations of its translations.
+ */
+typedef struct
+{
+    FILE *file;
+    RomanizationCache *romanizations;
+} HtmlContext;
+
+void initializeHtmlGeneratorModule()
+{
+    _logger = createLogger("HtmlGenerator");
+}
+
+void shutdownHtmlGeneratorModule()
+{
+    if (_logger != NULL)
+    {
+        destroyLogger(_logger);
+    }
+}
+
+/** PRIVATE FUNCTIONS */
+
+static void _escapeHtml(FILE *file, const char *text);
+static void _collectText(FILE *file, Content *content);
+static void _htmlContent(HtmlContext *context, Content *content);
+static void _htmlContentList(HtmlContext *context, ContentList *contentList, const char *separator);
+static void _htmlElement(HtmlContext *context, Element *element);
+static void _htmlCommand(HtmlContext *context, Command *command);
+static void _htmlLangtexCommand(HtmlContext *context, LangtexCommand *command);
+static void _htmlTranslate(HtmlContext *context, LangtexCommand *command);
+static void _htmlDialog(HtmlContext *context, LangtexCommand *command);
+static void _htmlSpeaker(HtmlContext *context, LangtexCommand *command);
+static void _htmlTable(HtmlContext *context, LangtexCommand *command);
+static void _htmlRow(HtmlContext *context, LangtexCommand *command);
+static void _htmlExercise(HtmlContext *context, LangtexCommand *command);
+static void _htmlAnswers(HtmlContext *context, LangtexCommand *answers, ContentList *options);
+static void _htmlBlock(HtmlContext *context, LangtexCommand *command);
+
+/**
+ * Writes the text with the HTML special characters escaped.
+ */
+static void _escapeHtml(FILE *file, const char *text)
+{
+    for (const char *c = text; c && *c; ++c)
+    {
+        switch (*c)
+        {
+        case '&':
+            fputs("&amp;", file);
+            break;
+        case '<':
+            fputs("&lt;", file);
+            break;
+        case '>':
+            fputs("&gt;", file);
+            break;
+        case '"':
+            fputs("&quot;", file);
+            break;
+        default:
+            fputc(*c, file);
+        }
+    }
+}
+
+/**
+ * Writes only the plain text of the content, unescaped, as it's romanized.
+ */
+static void _collectText(FILE *file, Content *content)
+{
+    for (; content != NULL; content = content->sequenceContent)
+    {
+        Element *element = content->sequenceElement;
+        if (element && element->type == LATEX_TEXT)
+        {
+            fputs(element->text->text, file);
+        }
+        else if (element && element->type == LATEX_COMMAND && element->command->type == PARAMETERIZED)
+        {
+            for (ContentList *list = element->command->parameterizedContentList; list; list = list->next)
+            {
+                _collectText(file, list->content);
+            }
+        }
+    }
+}
+
+static void _htmlContent(HtmlContext *context, Content *content)
+{
+    for (; content != NULL; content = content->sequenceContent)
+    {
+        _htmlElement(context, content->sequenceElement);
+    }
+}
+
+static void _htmlContentList(HtmlContext *context, ContentList *contentList, const char *separator)
+{
+    for (; contentList != NULL; contentList = contentList->next)
+    {
+        _htmlContent(context, contentList->content);
+        if (separator && contentList->next)
+        {
+            fputs(separator, context->file);
+        }
+    }
+}
+
+static void _htmlElement(HtmlContext *context, Element *element)
+{
+    if (!element)
+        return;
+    switch (element->type)
+    {
+    case LANGTEX_COMMAND:
+        _htmlLangtexCommand(context, element->langtexCommand);
+        break;
+    case LATEX_COMMAND:
+        _htmlCommand(context, element->command);
+        break;
+    case LATEX_TEXT:
+        _escapeHtml(context->file, element->text->text);
+        break;
+    default:
+        logError(_logger, "Unknown element type: %d", element->type);
+    }
+}
+
+/**
+ * Renders the sectioning and font commands, and passes any other LaTeX
+ * command through as text, with its arguments rendered.
+ */
+static void _htmlCommand(HtmlContext *context, Command *command)
+{
+    if (!command)
+        return;
+    if (command->type == PARAMETERIZED)
+    {
+        static const char *const tags[][2] = {
+            {"\\part", "h1"}, {"\\chapter", "h1"}, {"\\section", "h2"}, {"\\subsection", "h3"},
+            {"\\subsubsection", "h4"}, {"\\textbf", "b"}, {"\\textit", "i"}, {"\\emph", "em"},
+            {"\\underline", "u"}};
+        for (size_t k = 0; k < sizeof(tags) / sizeof(tags[0]); ++k)
+        {
+            if (strcmp(command->parameterizedCommand, tags[k][0]) == 0)
+            {
+                fprintf(context->file, "<%s>", tags[k][1]);
+                _htmlContentList(context, command->parameterizedContentList, NULL);
+                fprintf(context->file, "</%s>", tags[k][1]);
+                return;
+            }
+        }
+        _escapeHtml(context->file, command->parameterizedCommand);
+        fputs("{", context->file);
+        _htmlContentList(context, command->parameterizedContentList, NULL);
+        fputs("}", context->file);
+    }
+    else if (command->type == ENVIRONMENT)
+    {
+        fputs("<div class=\"environment\">", context->file);
+        fputs("<code>\\begin{", context->file);
+        _escapeHtml(context->file, command->environmentLeftText->text);
+        fputs("}</code>", context->file);
+        _htmlContent(context, command->environmentContent);
+        fputs("<code>\\end{", context->file);
+        _escapeHtml(context->file, command->environmentLeftText->text);
+        fputs("}</code></div>\n", context->file);
+    }
+}
+
+static void _htmlLangtexCommand(HtmlContext *context, LangtexCommand *command)
+{
+    if (!command)
+        return;
+    switch (command->type)
+    {
+    case LANGTEX_TRANSLATE:
+        _htmlTranslate(context, command);
+        break;
+    case LANGTEX_DIALOG:
+        _htmlDialog(context, command);
+        break;
+    case LANGTEX_SPEAKER:
+        _htmlSpeaker(context, command);
+        break;
+    case LANGTEX_EXERCISE:
+        _htmlExercise(context, command);
+        break;
+    case LANGTEX_TABLE:
+        _htmlTable(context, command);
+        break;
+    case LANGTEX_ROW:
+        _htmlRow(context, command);
+        break;
+    case LANGTEX_BLOCK:
+        _htmlBlock(context, command);
+        break;
+    case LANGTEX_PROMPT:
+        _htmlContent(context, command->content);
+        break;
+    case LANGTEX_FILL:
+        fputs("<span class=\"fill\"></span>", context->file);
+        break;
+    default:
+        logError(_logger, "Unknown LaNgTeX command type: %d", command->type);
+        break;
+    }
+}
+
+/**
+ * Renders the original text with its romanization above it, followed by its
+ * translation, as "\\rom" typesets it.
+ */
+static void _htmlTranslate(HtmlContext *context, LangtexCommand *command)
+{
+    LangtexParam *language = getParameter(command->parameters, "lang");
+    LangtexParam *scheme = getParameter(command->parameters, "scheme");
+    char *original = NULL;
+    size_t length = 0;
+    FILE *stream = open_memstream(&original, &length);
+    _collectText(stream, command->leftText);
+    fclose(stream);
+
+    // Text typed romanized is converted into the native script, and it's its own romanization.
+    LangtexParam *input = getParameter(command->parameters, "input");
+    const char *romanizedWord = NULL;
+    const char *native = original;
+    if (language && input && strcmp(input->value.stringParam, "roman") == 0)
+    {
+        native = getDeromanization(context->romanizations, language->value.stringParam, scheme ? scheme->value.stringParam : NULL, original);
+        romanizedWord = original;
+    }
+    else if (language)
+    {
+        romanizedWord = getRomanization(context->romanizations, language->value.stringParam, scheme ? scheme->value.stringParam : NULL, original);
+    }
+    fputs("<span class=\"rom\"><ruby>", context->file);
+    _escapeHtml(context->file, native);
+    fputs("<rt>", context->file);
+    _escapeHtml(context->file, romanizedWord ? romanizedWord : "");
+    fputs("</rt></ruby> <span class=\"translation\">", context->file);
+    _htmlContent(context, command->rightText);
+    fputs("</span></span>", context->file);
+    free(original);
+}
+
+static void _htmlDialog(HtmlContext *context, LangtexCommand *command)
+{
+    fputs("<div class=\"dialog\">\n", context->file);
+    for (LangtexCommandList *list = command->langtexCommandList; list; list = list->next)
+    {
+        _htmlLangtexCommand(context, list->command);
+    }
+    fputs("</div>\n", context->file);
+}
+
+static void _htmlSpeaker(HtmlContext *context, LangtexCommand *command)
+{
+    LangtexParam *name = getParameter(command->parameters, "name");
+    fputs("<p class=\"speaker\"><b>", context->file);
+    _escapeHtml(context->file, name ? name->value.stringParam : "");
+    fputs(":</b> ", context->file);
+    _htmlContent(context, command->content);
+    fputs("</p>\n", context->file);
+}
+
+static void _htmlTable(HtmlContext *context, LangtexCommand *command)
+{
+    fputs("<table>\n", context->file);
+    for (LangtexCommandList *list = command->langtexCommandList; list; list = list->next)
+    {
+        _htmlRow(context, list->command);
+    }
+    fputs("</table>\n", context->file);
+}
+
+static void _htmlRow(HtmlContext *context, LangtexCommand *command)
+{
+    if (!command)
+        return;
+    LangtexParam *header = getParameter(command->parameters, "header");
+    const char *cell = header && header->value.boolParam ? "th" : "td";
+    fputs("<tr>", context->file);
+    for (ContentList *list = command->contentList; list; list = list->next)
+    {
+        fprintf(context->file, "<%s>", cell);
+        _htmlContent(context, list->content);
+        fprintf(context->file, "</%s>", cell);
+    }
+    fputs("</tr>\n", context->file);
+}
+
+static void _htmlExercise(HtmlContext *context, LangtexCommand *command)
+{
+    LangtexParam *title = getParameter(command->parameters, "title");
+    fputs("<div class=\"exercise\">\n<div class=\"title\">", context->file);
+    _escapeHtml(context->file, title ? title->value.stringParam : "");
+    fputs("</div>\n<p>", context->file);
+    _htmlLangtexCommand(context, command->prompt);
+    fputs("</p>\n", context->file);
+    if (command->options)
+    {
+        fputs("<p><b>Options:</b> ", context->file);
+        _htmlContentList(context, command->options->contentList, ", ");
+        fputs("</p>\n", context->file);
+    }
+    fputs("<details><summary>Answer</summary>", context->file);
+    _htmlAnswers(context, command->answers, command->options ? command->options->contentList : NULL);
+    fputs("</details>\n</div>\n", context->file);
+}
+
+/**
+ * Renders the answers of an exercise. With options, the answers are the
+ * (1-based) indices of the right ones, listed in the order of the options.
+ */
+static void _htmlAnswers(HtmlContext *context, LangtexCommand *answers, ContentList *options)
+{
+    if (!answers || !answers->contentList)
+        return;
+    if (options == NULL)
+    {
+        _htmlContent(context, answers->contentList->content);
+        return;
+    }
+    bool isFirst = true;
+    for (int index = 1; options != NULL; ++index, options = options->next)
+    {
+        for (ContentList *answer = answers->contentList; answer; answer = answer->next)
+        {
+            if (atoi(answer->content->sequenceElement->text->text) == index)
+            {
+                fputs(isFirst ? "" : ", ", context->file);
+                _htmlContent(context, options->content);
+                isFirst = false;
+                break;
+            }
+        }
+    }
+}
+
+static void _htmlBlock(HtmlContext *context, LangtexCommand *command)
+{
+    fputs("<div class=\"block\"><div class=\"title\">", context->file);
+    _escapeHtml(context->file, command->parameters ? command->parameters->param->value.stringParam : "Block");
+    fputs("</div>\n", context->file);
+    _htmlContent(context, command->content);
+    fputs("</div>\n", context->file);
+}
+
+/** PUBLIC FUNCTIONS */
+
+void generateHtml(char * outputDir, char * fileName, CompilerState * compilerState)
+{
+    FILE *file = stdout;
+    char *outputPath = NULL;
+    if (outputDir != NULL)
+    {
+        struct stat st = {0};
+        if (stat(outputDir, &st) == -1 && mkdir(outputDir, 0755) == -1)
+        {
+            logError(_logger, "Could not create directory: %s", outputDir);
+            return;
+        }
+        size_t nameLength = strlen(fileName);
+        if (4 <= nameLength && strcmp(fileName + nameLength - 4, ".tex") == 0)
+        {
+            nameLength -= 4;
+        }
+        outputPath = malloc(strlen(outputDir) + nameLength + strlen("/.html") + 1);
+        sprintf(outputPath, "%s/%.*s.html", outputDir, (int) nameLength, fileName);
+        file = fopen(outputPath, "w");
+        if (file == NULL)
+        {
+            logError(_logger, "Could not create/open file: %s", outputPath);
+            free(outputPath);
+            return;
+        }
+    }
+    logDebugging(_logger, "Generating HTML preview to %s", outputPath ? outputPath : "stdout");
+
+    fputs("<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>LaNgTeX preview</title>\n"
+          "<style>\n"
+          "body { font-family: serif; max-width: 50em; margin: auto; white-space: pre-wrap; }\n"
+          ".exercise, .block, .dialog { border: 1px solid black; padding: 0.5em; margin: 1em 0; white-space: normal; }\n"
+          ".title { font-weight: bold; }\n"
+          ".translation { color: #555; }\n"
+          ".fill { display: inline-block; width: 3em; border-bottom: 1px solid black; }\n"
+          "table { border-collapse: collapse; white-space: normal; }\n"
+          "td, th { border: 1px solid black; padding: 0.2em 0.5em; }\n"
+          "</style>\n</head>\n<body>\n", file);
+    Program *program = compilerState->abstractSyntaxtTree;
+    HtmlContext context = {.file = file, .romanizations = createRomanizationCache()};
+    if (program)
+    {
+        _htmlContent(&context, program->content);
+    }
+    logRomanizationCacheStatistics(context.romanizations);
+    destroyRomanizationCache(context.romanizations);
+    fputs("\n</body>\n</html>\n", file);
+
+    if (file != stdout && fclose(file) != 0)
+    {
+        logError(_logger, "Error while closing file");
+    }
+    free(outputPath);
+    logDebugging(_logger, "HTML preview is done.");
+}
@@ -0,0 +1,30 @@
+#ifndef HTML_GENERATOR_HEADER
+#define HTML_GENERATOR_HEADER
+
+#include "../domain-specific/SemanticAnalyzer.h"
+#include "../romanizers/romanize.h"
+#include "../romanizers/RomanizationCache.h"
+#include "../../frontend/syntactic-analysis/LangTeXAST.h"
+#include "../../shared/CompilerState.h"
+#include "../../shared/Logger.h"
+#include "../../shared/String.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/stat.h>
+
+/** Initialize module's internal state. */
+void initializeHtmlGeneratorModule();
+
+/** Shutdown module's internal state. */
+void shutdownHtmlGeneratorModule();
+
+/**
+ * Generates a quick HTML preview of the program, instead of the LaTeX
+ * document. LaNgTeX commands are rendered (with the same romanizations), and
+ * LaTeX is passed through as escaped text, except for a few sectioning and
+ * font commands. The preview is written to "<file>.html" inside the output
+ * directory, or to standard output if there's none.
+ */
+void generateHtml(char * outputDir, char * fileName, CompilerState * compilerState);
+
+#endif
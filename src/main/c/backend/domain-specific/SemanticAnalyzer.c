@@ -2,9 +2,26 @@
 
 static Logger *_logger = NULL;
 
+// The warnings reported so far, so the ones of every block can be cached.
+static size_t _warningCount = 0;
+
+static void _warn(const char *const format, ...);
+static boolean validateLatexInCommand(Command *command);
+static boolean validateLatexInElement(Element *element);
+static boolean validateLatexInContent(Content *content);
+static boolean validateLangtexContent(Content *content);
+static boolean validateLangtexElement(Element *element);
+static boolean validatePromptContent(Content *content);
+static void collectTextOfContent(StringBuilder *output, Content *content);
+static boolean validateScriptOfContent(Content *content, const char *langCode);
+static void validateReadingsOfContent(Content *content);
+static boolean validateSingleChoiceExercise(LangtexCommand *prompt, LangtexCommand *answer);
+static boolean validateMultipleChoiceExercise(LangtexCommand *prompt, LangtexCommand *options, LangtexCommand *answers);
+
 void initializeSemanticAnalyzer()
 {
     _logger = createLogger("SemanticAnalyzer");
+    _warningCount = 0;
     logDebugging(_logger, "Initializing semantic analyzer for [!translate]");
 }
 
@@ -17,6 +34,23 @@ void shutdownSemanticAnalyzer()
     }
 }
 
+/**
+ * Reports a warning of the program. Every warning goes through it, so that
+ * the ones of each block are counted (a cached block with warnings is
+ * analyzed again, so they are reported on every compilation).
+ */
+static void _warn(const char *const format, ...)
+{
+    StringBuilder message = {0};
+    va_list arguments;
+    va_start(arguments, format);
+    appendFormatList(&message, format, arguments);
+    va_end(arguments);
+    ++_warningCount;
+    logWarning(_logger, "%s", peekStringBuilder(&message));
+    releaseStringBuilder(&message);
+}
+
 /**
  * Simple helper to get parameter by name
  */
@@ -34,14 +68,6 @@ LangtexParam *getParameter(LangtexParamList *params, const char *name)
     return NULL;
 }
 
-/* SUPPORTED LANGUAGES */
-static const char *SUPPORTED_LANGUAGES[] = {
-    "ko", // Korean
-    "ru", // Russian
-    "he", // Hebrew
-    NULL  // Sentinel
-};
-
 /* ALLOWED LATEX COMMANDS INSIDE \text{} for TRANSLATE command */
 static const char *ALLOWED_LATEX_COMMANDS[] = {
     "\\textbf",    // Bold text
@@ -95,19 +121,114 @@ static boolean validateLangtexElement(Element *el)
 }
 
 /* HELPER FUNCTIONS FOR TRANSLATE COMMAND */
+// The supported languages are the ones with a romanization table (see "schemes.tsv").
 static boolean isLanguageSupported(const char *langCode)
 {
     if (!langCode)
         return false;
 
-    for (int i = 0; SUPPORTED_LANGUAGES[i] != NULL; i++)
+    return isRomanizationSchemeSupported(langCode, NULL);
+}
+
+// Appends the text of the content, without the LaTeX commands around it.
+static void collectTextOfContent(StringBuilder *output, Content *content)
+{
+    for (; content && content->type == SEQUENCE; content = content->sequenceContent)
     {
-        if (strcmp(SUPPORTED_LANGUAGES[i], langCode) == 0)
+        Element *element = content->sequenceElement;
+        if (!element)
+            continue;
+        if (element->type == LATEX_TEXT && element->text)
         {
-            return true;
+            appendString(output, element->text->text);
+        }
+        else if (element->type == LATEX_COMMAND && element->command && element->command->type == PARAMETERIZED)
+        {
+            for (ContentList *current = element->command->parameterizedContentList; current; current = current->next)
+            {
+                collectTextOfContent(output, current->content);
+            }
         }
     }
-    return false;
+}
+
+// Returns the offset of the codepoint in the (valid) UTF-8 text.
+static size_t byteOffsetOfCodepoint(const char *text, size_t codepoint)
+{
+    size_t offset = 0;
+    for (; text[offset] != '\0'; ++offset)
+    {
+        if ((text[offset] & 0xC0) != 0x80 && codepoint-- == 0)
+            break;
+    }
+    return offset;
+}
+
+/**
+ * Checks that the source text is written in a script of the language. Text in
+ * another script can't be romanized (it's dropped), so it's an error when the
+ * language isn't used at all, and a warning when it's mixed with it.
+ */
+static boolean validateScriptOfContent(Content *content, const char *langCode)
+{
+    StringBuilder text = {0};
+    collectTextOfContent(&text, content);
+    const char *source = peekStringBuilder(&text);
+    ScriptReport report;
+    if (!checkScripts(&report, langCode, source) || report.spanCount == 0)
+    {
+        releaseStringBuilder(&text);
+        return true;
+    }
+
+    const boolean isMismatched = !report.hasLanguageScript;
+    const char *scripts = getLanguageScriptNames(langCode);
+    for (size_t k = 0; k < report.spanCount && k < MAXIMUM_SCRIPT_SPANS; ++k)
+    {
+        const ScriptSpan *span = &report.spans[k];
+        const size_t first = byteOffsetOfCodepoint(source, span->first);
+        const size_t last = byteOffsetOfCodepoint(source, span->last);
+        if (isMismatched)
+        {
+            logError(_logger, "[!translate] source text is in %s, but '%s' is written in %s: \"%.*s\" (characters %zu-%zu)",
+                     getScriptName(span->script), langCode, scripts, (int)(last - first), source + first, span->first + 1, span->last);
+        }
+        else
+        {
+            _warn("[!translate] source text in '%s' mixes in %s, that won't be romanized: \"%.*s\" (characters %zu-%zu)",
+                  langCode, getScriptName(span->script), (int)(last - first), source + first, span->first + 1, span->last);
+        }
+    }
+    if (MAXIMUM_SCRIPT_SPANS < report.spanCount)
+    {
+        _warn("[!translate] ...and %zu more spans in other scripts", report.spanCount - MAXIMUM_SCRIPT_SPANS);
+    }
+    releaseStringBuilder(&text);
+    return !isMismatched;
+}
+
+/**
+ * Chinese is romanized with a dictionary, and a character without a reading
+ * is kept as it is (see "romanizePinyin"). That is reported by the analysis,
+ * and not by the romanization, so it's reported again when the block is
+ * cached (as any warning of a block).
+ */
+static void validateReadingsOfContent(Content *content)
+{
+    // A missing dictionary was reported when it was loaded.
+    if (!isPinyinDictionaryAvailable())
+    {
+        return;
+    }
+    StringBuilder text = {0};
+    StringBuilder missing = {0};
+    collectTextOfContent(&text, content);
+    if (findMissingPinyinReadings(&missing, peekStringBuilder(&text)) != 0)
+    {
+        _warn("[!translate] the dictionary has no reading of these characters, so they are kept as they are:%s", peekStringBuilder(&missing));
+    }
+    releaseStringBuilder(&missing);
+    releaseStringBuilder(&text);
 }
 
 static boolean validateLatexCommand(char *command)
@@ -337,10 +458,32 @@ static boolean validateMultipleChoiceExercise(LangtexCommand *prompt, LangtexCom
 
 /* PUBLIC FUNCTIONS */
 
-SemanticAnalysisStatus analyzeProgram(Program *program)
+SemanticAnalysisStatus analyzeProgram(Program *program, BlockCache *blockCache)
 {
     logDebugging(_logger, "Starting semantic analysis");
-    return analyzeContent(program->content);
+    if (!blockCache)
+    {
+        return analyzeContent(program->content);
+    }
+
+    size_t index = 0;
+    for (Content *content = program->content; content != NULL; content = content->sequenceContent, ++index)
+    {
+        // A clean block was accepted before, but its warnings are reported again.
+        const CachedBlock *cached = getCachedBlock(blockCache, index);
+        if (cached && cached->warnings == 0)
+        {
+            continue;
+        }
+        const size_t warnings = _warningCount;
+        SemanticAnalysisStatus status = analyzeElement(content->sequenceElement);
+        if (status != SEMANTIC_ANALYSIS_ACCEPT)
+        {
+            return status;
+        }
+        storeBlockAnalysis(blockCache, index, _warningCount - warnings);
+    }
+    return SEMANTIC_ANALYSIS_ACCEPT;
 }
 
 SemanticAnalysisStatus analyzeContent(Content *content)
@@ -445,6 +588,7 @@ SemanticAnalysisStatus analyzeTranslateCommand(LangtexCommand *command)
     }
 
     char *languageCode = NULL;
+    boolean isRomanized = false;
     if (command->parameters)
     {
         LangtexParam *langParam = getParameter(command->parameters, "lang");
@@ -466,17 +610,70 @@ SemanticAnalysisStatus analyzeTranslateCommand(LangtexCommand *command)
             logDebugging(_logger, "[!translate] using language: %s", languageCode);
         }
 
+        LangtexParam *schemeParam = getParameter(command->parameters, "scheme");
+        if (schemeParam)
+        {
+            if (schemeParam->type != STRING_PARAMETER)
+            {
+                logError(_logger, "[!translate] 'scheme' parameter must be a string");
+                return SEMANTIC_ANALYSIS_ERROR;
+            }
+
+            if (!languageCode || !isRomanizationSchemeSupported(languageCode, schemeParam->value.stringParam))
+            {
+                logError(_logger, "[!translate] unsupported romanization scheme: '%s'", schemeParam->value.stringParam);
+                return SEMANTIC_ANALYSIS_ERROR;
+            }
+        }
+
+        // The left side can be typed romanized (with the scheme), if it can be converted back.
+        LangtexParam *inputParam = getParameter(command->parameters, "input");
+        if (inputParam)
+        {
+            if (inputParam->type != STRING_PARAMETER)
+            {
+                logError(_logger, "[!translate] 'input' parameter must be a string");
+                return SEMANTIC_ANALYSIS_ERROR;
+            }
+
+            const char *input = inputParam->value.stringParam;
+            isRomanized = strcmp(input, "roman") == 0;
+            if (isRomanized)
+            {
+                if (!languageCode || !isDeromanizationSupported(languageCode, schemeParam ? schemeParam->value.stringParam : NULL))
+                {
+                    logError(_logger, "[!translate] romanized input is not supported for language '%s'", languageCode ? languageCode : "(none)");
+                    return SEMANTIC_ANALYSIS_ERROR;
+                }
+            }
+            else if (strcmp(input, "native") != 0)
+            {
+                logError(_logger, "[!translate] 'input' parameter must be \"native\" or \"roman\", got: '%s'", input);
+                return SEMANTIC_ANALYSIS_ERROR;
+            }
+        }
+
         // Check for any other parameters (shouldnt exist)
         LangtexParamList *current = command->parameters;
         while (current && current->param)
         {
-            if (strcmp(current->param->key, "lang") != 0)
+            if (strcmp(current->param->key, "lang") != 0 && strcmp(current->param->key, "scheme") != 0 && strcmp(current->param->key, "input") != 0)
             {
-                logWarning(_logger, "[!translate] unknown parameter '%s'", current->param->key);
+                _warn("[!translate] unknown parameter '%s'", current->param->key);
             }
             current = current->next;
         }
     }
+
+    // Romanized input is written in Latin, so only native input is checked.
+    if (languageCode && !isRomanized && !validateScriptOfContent(command->leftText, languageCode))
+    {
+        return SEMANTIC_ANALYSIS_ERROR;
+    }
+    if (languageCode && !isRomanized && strcmp(languageCode, "zh") == 0)
+    {
+        validateReadingsOfContent(command->leftText);
+    }
     return SEMANTIC_ANALYSIS_ACCEPT;
 }
 
@@ -511,13 +708,24 @@ SemanticAnalysisStatus analyzeTableCommand(LangtexCommand *command)
             cols = langParam->value.intParam;
         }
 
+        LangtexParam *longParam = getParameter(command->parameters, "long");
+        if (longParam)
+        {
+            if (longParam->type != BOOLEAN_PARAMETER)
+            {
+                logError(_logger, "[!table] 'long' parameter must be boolean");
+                return SEMANTIC_ANALYSIS_ERROR;
+            }
+            logDebugging(_logger, "[!table] using long: %s", longParam->value.boolParam ? "true" : "false");
+        }
+
         // Check for any other parameters (shouldnt exist)
         LangtexParamList *current = command->parameters;
         while (current && current->param)
         {
-            if (strcmp(current->param->key, "cols") != 0)
+            if (strcmp(current->param->key, "cols") != 0 && strcmp(current->param->key, "long") != 0)
             {
-                logWarning(_logger, "[!table] unknown parameter '%s'", current->param->key);
+                _warn("[!table] unknown parameter '%s'", current->param->key);
             }
             current = current->next;
         }
@@ -595,7 +803,7 @@ SemanticAnalysisStatus analyzeRowCommand(LangtexCommand *command, int expectedCo
         {
             if (strcmp(current->param->key, "header") != 0)
             {
-                logWarning(_logger, "[!row] unknown parameter '%s'", current->param->key);
+                _warn("[!row] unknown parameter '%s'", current->param->key);
             }
             current = current->next;
         }
@@ -665,7 +873,7 @@ SemanticAnalysisStatus analyzeDialogCommand(LangtexCommand *command)
         {
             if (strcmp(current->param->key, "title") != 0 && strcmp(current->param->key, "style") != 0)
             {
-                logWarning(_logger, "[!dialog] unknown parameter '%s'", current->param->key);
+                _warn("[!dialog] unknown parameter '%s'", current->param->key);
             }
             current = current->next;
         }
@@ -729,7 +937,7 @@ SemanticAnalysisStatus analyzeSpeakerCommand(LangtexCommand *command)
         {
             if (strcmp(current->param->key, "name") != 0)
             {
-                logWarning(_logger, "[!speaker] unknown parameter '%s'", current->param->key);
+                _warn("[!speaker] unknown parameter '%s'", current->param->key);
             }
             current = current->next;
         }
@@ -772,7 +980,7 @@ SemanticAnalysisStatus analyzeBlockCommand(LangtexCommand *command)
         LangtexParam *first = getParameter(command->parameters, key);
         if (first != param)
         {
-            logWarning(_logger, "[!block] duplicate parameter '%s' found — only the first will be used", key);
+            _warn("[!block] duplicate parameter '%s' found — only the first will be used", key);
             current = current->next;
             continue; // Skip further processing for duplicates
         }
@@ -789,7 +997,7 @@ SemanticAnalysisStatus analyzeBlockCommand(LangtexCommand *command)
         }
         else
         {
-            logWarning(_logger, "[!block] unknown parameter '%s'", key);
+            _warn("[!block] unknown parameter '%s'", key);
         }
 
         current = current->next;
@@ -824,7 +1032,7 @@ SemanticAnalysisStatus analyzeExerciseCommand(LangtexCommand *command)
         LangtexParam *first = getParameter(command->parameters, key);
         if (first != param)
         {
-            logWarning(_logger, "[!exercise] duplicate parameter '%s' found — only the first will be used", key);
+            _warn("[!exercise] duplicate parameter '%s' found — only the first will be used", key);
             current = current->next;
             continue; // Skip further processing for duplicates
         }
@@ -851,7 +1059,7 @@ SemanticAnalysisStatus analyzeExerciseCommand(LangtexCommand *command)
         }
         else
         {
-            logWarning(_logger, "[!exercise] unknown parameter '%s'", key);
+            _warn("[!exercise] unknown parameter '%s'", key);
         }
 
         current = current->next;
@@ -884,7 +1092,7 @@ SemanticAnalysisStatus analyzeExerciseCommand(LangtexCommand *command)
         }
         if (command->options != NULL)
         {
-            logWarning(_logger, "[!exercise] [!single-choice] command should not have options");
+            _warn("[!exercise] [!single-choice] command should not have options");
         }
         if (validateSingleChoiceExercise(command->prompt, command->answers))
         {
@@ -6,6 +6,11 @@
 #include "../../shared/CompilerState.h"
 #include "../../shared/Logger.h"
 #include "../../shared/SymbolTable.h"
+#include "../code-generation/BlockCache.h"
+#include "../romanizers/PinyinDictionary.h"
+#include "../romanizers/romanize.h"
+#include "../romanizers/ScriptClassifier.h"
+#include <stdarg.h>
 #include <stdlib.h>
 
 
@@ -23,7 +28,11 @@ void initializeSemanticAnalyzer();
 void shutdownSemanticAnalyzer();
 
 /* MAIN ANALYSIS FUNCTIONS */
-SemanticAnalysisStatus analyzeProgram(Program* program);
+/**
+ * Analyzes the whole program. With a block cache, every top-level element that
+ * was already accepted in a previous compilation is skipped.
+ */
+SemanticAnalysisStatus analyzeProgram(Program* program, BlockCache* blockCache);
 SemanticAnalysisStatus analyzeContent(Content* content);
 SemanticAnalysisStatus analyzeElement(Element* element);
 SemanticAnalysisStatus analyzeLangtexCommand(LangtexCommand* command);
@@ -38,12 +47,4 @@ SemanticAnalysisStatus analyzeExerciseCommand(LangtexCommand *command);
 
 /* HELPER FUNCTIONS */
 LangtexParam* getParameter(LangtexParamList* params, const char* name);
-static boolean validateLatexInCommand(Command *command);
-static boolean validateLatexInElement(Element *element);
-static boolean validateLatexInContent(Content *content);
-static boolean validateLangtexContent(Content *content);
-static boolean validateLangtexElement(Element *element);
-static boolean validatePromptContent(Content *content);
-static boolean validateSingleChoiceExercise(LangtexCommand *prompt, LangtexCommand *answer);
-static boolean validateMultipleChoiceExercise(LangtexCommand *prompt, LangtexCommand *options, LangtexCommand *answers);
 #endif
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "PinyinDictionary.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* MODULE INTERNAL STATE */
+
+#ifndef PINYIN_DICTIONARY_PATH
+#define PINYIN_DICTIONARY_PATH "pinyin.dat"
+#endif
+
+#define HEADER_SIZE (8 + 2 * sizeof(uint32_t))
+
+static Logger * _logger = NULL;
+
+/**
+ * The mapped file, and its arrays inside it. Nothing is mapped if the file is
+ * missing or invalid.
+ */
+static void * _file = NULL;
+static size_t _fileSize = 0;
+static const int32_t * _base = NULL;
+static const int32_t * _check = NULL;
+static uint32_t _unitCount = 0;
+static const char * _readings = NULL;
+static uint32_t _readingsLength = 0;
+
+static void _mapDictionary();
+
+void initializePinyinDictionaryModule()
+{
+    _logger = createLogger("PinyinDictionary");
+    // It's mapped before any parallel task can read it.
+    _mapDictionary();
+}
+
+void shutdownPinyinDictionaryModule()
+{
+    if (_file != NULL)
+    {
+        munmap(_file, _fileSize);
+        _file = NULL;
+    }
+    if (_logger != NULL)
+    {
+        destroyLogger(_logger);
+    }
+}
+
+/* PRIVATE FUNCTIONS */
+
+static boolean _validate(const unsigned char * file, const size_t size);
+
+// The header must fit, and every offset of the file must be inside it.
+static boolean _validate(const unsigned char * file, const size_t size)
+{
+    if (size < HEADER_SIZE || memcmp(file, PINYIN_DICTIONARY_MAGIC, 8) != 0)
+    {
+        return false;
+    }
+    uint32_t header[2];
+    memcpy(header, file + 8, sizeof(header));
+    if (header[0] == 0 || (size - HEADER_SIZE) / (2 * sizeof(int32_t)) < header[0]
+        || size - HEADER_SIZE - 2 * sizeof(int32_t) * (size_t) header[0] != header[1]
+        || header[1] == 0 || file[size - 1] != '\0')
+    {
+        return false;
+    }
+    _unitCount = header[0];
+    _readingsLength = header[1];
+    _base = (const int32_t *) (file + HEADER_SIZE);
+    _check = _base + _unitCount;
+    _readings = (const char *) (_check + _unitCount);
+    return true;
+}
+
+static void _mapDictionary()
+{
+    const char * path = getStringOrDefault("PINYIN_DICTIONARY", PINYIN_DICTIONARY_PATH);
+    const int descriptor = open(path, O_RDONLY);
+    struct stat status;
+    if (descriptor < 0 || fstat(descriptor, &status) != 0 || status.st_size <= 0)
+    {
+        logWarning(_logger, "The dictionary is missing (\"%s\"), so Chinese can't be romanized.", path);
+        if (0 <= descriptor)
+        {
+            close(descriptor);
+        }
+        return;
+    }
+    void * file = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (file == MAP_FAILED)
+    {
+        logWarning(_logger, "The dictionary can't be mapped (\"%s\").", path);
+        return;
+    }
+    if (!_validate(file, (size_t) status.st_size))
+    {
+        logWarning(_logger, "The dictionary is invalid (\"%s\").", path);
+        munmap(file, (size_t) status.st_size);
+        return;
+    }
+    _file = file;
+    _fileSize = (size_t) status.st_size;
+    logDebugging(_logger, "Mapped the dictionary (%u units, %u bytes of readings).", _unitCount, _readingsLength);
+}
+
+/* PUBLIC FUNCTIONS */
+
+boolean isPinyinDictionaryAvailable()
+{
+    return _file != NULL;
+}
+
+Hash hashPinyinDictionaryIdentity(Hash hash)
+{
+    const char * path = getStringOrDefault("PINYIN_DICTIONARY", PINYIN_DICTIONARY_PATH);
+    hash = hashString(hash, path);
+    struct stat status;
+    if (stat(path, &status) == 0)
+    {
+        hash = hashInteger(hash, (int64_t) status.st_size);
+        hash = hashInteger(hash, (int64_t) status.st_mtime);
+    }
+    return hash;
+}
+
+size_t matchPinyinWord(const char * text, const size_t length, const char ** reading)
+{
+    if (!isPinyinDictionaryAvailable())
+    {
+        return 0;
+    }
+    size_t matched = 0;
+    uint32_t state = 0;
+    for (size_t k = 0; k <= length; ++k)
+    {
+        // A word ends here if the state has a terminal child.
+        const int64_t terminal = (int64_t) _base[state] + PINYIN_TERMINAL_LABEL;
+        if (0 <= terminal && terminal < _unitCount && _check[terminal] == (int32_t) state
+            && (uint32_t) _base[terminal] < _readingsLength)
+        {
+            matched = k;
+            *reading = _readings + _base[terminal];
+        }
+        if (k == length)
+        {
+            break;
+        }
+        const int64_t next = (int64_t) _base[state] + (unsigned char) text[k] + 1;
+        if (next < 0 || _unitCount <= next || _check[next] != (int32_t) state)
+        {
+            break;
+        }
+        state = (uint32_t) next;
+    }
+    return matched;
+}
@@ -0,0 +1,58 @@
+#ifndef PINYIN_DICTIONARY_HEADER
+#define PINYIN_DICTIONARY_HEADER
+
+#include "../../shared/Environment.h"
+#include "../../shared/Hash.h"
+#include "../../shared/Logger.h"
+#include "../../shared/StringBuilder.h"
+#include "../../shared/Type.h"
+#include "../../shared/Utf8.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The dictionary of Chinese words and their readings in pinyin (with tone
+ * marks), generated at build time by "PinyinDictionaryGenerator" from a
+ * CC-CEDICT file. It's a double-array trie over the UTF-8 bytes of the words,
+ * that is mapped into memory as it is (so it's loaded without copying, and
+ * only the pages that are used are ever read). The file holds:
+ *
+ *	- the magic "PINYIN01";
+ *	- the number of units, and the length of the readings (as uint32_t);
+ *	- the bases and the checks of the units (as int32_t), in native byte order;
+ *	- the readings, every one ending in NUL.
+ *
+ * The child of the unit "s" by the label "c" is "base[s] + c", if its check
+ * is "s", where the label of a byte is the byte plus one and the label zero
+ * ends a word. The base of that terminal unit is the offset of its reading.
+ * The root is the unit zero.
+ *
+ * The path of the file is the variable "PINYIN_DICTIONARY", or the one given
+ * at build time. It's mapped when the module is initialized.
+ */
+
+#define PINYIN_DICTIONARY_MAGIC "PINYIN01"
+#define PINYIN_TERMINAL_LABEL 0
+
+/** Initialize module's internal state. */
+void initializePinyinDictionaryModule();
+
+/** Shutdown module's internal state. */
+void shutdownPinyinDictionaryModule();
+
+/** Returns whether the dictionary can be used. */
+boolean isPinyinDictionaryAvailable();
+
+/**
+ * Feeds the identity of the dictionary file (its path, size and modification
+ * time) to the hash, so anything derived from it can tell when it changes.
+ */
+Hash hashPinyinDictionaryIdentity(Hash hash);
+
+/**
+ * Finds the longest word of the dictionary that starts the text, and returns
+ * its length in bytes (or zero if there isn't any), with its reading.
+ */
+size_t matchPinyinWord(const char * text, const size_t length, const char ** reading);
+
+#endif
@@ -0,0 +1,295 @@
+#include "RomanizationCache.h"
+
+/* MODULE INTERNAL STATE */
+
+// Every shard has its own lock, so parallel tasks rarely wait for each other.
+#define SHARD_COUNT 16
+#define INITIAL_CAPACITY 64
+#define ARENA_CHUNK_SIZE 16384
+
+static Logger * _logger = NULL;
+
+// Every thread keeps its own scratch builder, to romanize without allocating.
+// It's released when the thread exits (or with the module, for the main one).
+static pthread_key_t _scratchKey;
+
+/**
+ * A chunk of the arena. Strings are bump-allocated in the last one, and they
+ * never move, so they can be handed out.
+ */
+typedef struct ArenaChunk
+{
+    struct ArenaChunk * next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} ArenaChunk;
+
+/**
+ * A memoized romanization. Every string lives in the arena.
+ */
+typedef struct
+{
+    Hash hash;
+    const char * language;
+    // The scheme, or an empty string for the default one.
+    const char * scheme;
+    // Whether the input is romanized, and converted into the native script.
+    boolean isDeromanization;
+    const char * input;
+    const char * romanization;
+} CachedRomanization;
+
+/**
+ * An open-addressing table (with linear probing) of a part of the keys.
+ */
+typedef struct
+{
+    pthread_mutex_t lock;
+    CachedRomanization * entries;
+    size_t capacity;
+    size_t count;
+    ArenaChunk * arena;
+    size_t hits;
+    size_t misses;
+} RomanizationShard;
+
+struct RomanizationCache
+{
+    RomanizationShard shards[SHARD_COUNT];
+};
+
+static void _releaseScratch(void * scratch);
+
+void initializeRomanizationCacheModule()
+{
+    _logger = createLogger("RomanizationCache");
+    pthread_key_create(&_scratchKey, _releaseScratch);
+}
+
+void shutdownRomanizationCacheModule()
+{
+    StringBuilder * scratch = pthread_getspecific(_scratchKey);
+    if (scratch != NULL)
+    {
+        pthread_setspecific(_scratchKey, NULL);
+        _releaseScratch(scratch);
+    }
+    pthread_key_delete(_scratchKey);
+    if (_logger != NULL)
+    {
+        destroyLogger(_logger);
+    }
+}
+
+/* PRIVATE FUNCTIONS */
+
+static StringBuilder * _getScratch();
+
+static const char * _storeString(RomanizationShard * shard, const char * string, const size_t length);
+static CachedRomanization * _findSlot(CachedRomanization * entries, const size_t capacity, const Hash hash, const char * language, const char * scheme, const boolean isDeromanization, const char * input);
+static const char * _convert(RomanizationCache * cache, const char * language, const char * scheme, const boolean isDeromanization, const char * input);
+static void _growShard(RomanizationShard * shard);
+
+static void _releaseScratch(void * scratch)
+{
+    releaseStringBuilder(scratch);
+    free(scratch);
+}
+
+static StringBuilder * _getScratch()
+{
+    StringBuilder * scratch = pthread_getspecific(_scratchKey);
+    if (scratch == NULL)
+    {
+        scratch = calloc(1, sizeof(StringBuilder));
+        pthread_setspecific(_scratchKey, scratch);
+    }
+    return scratch;
+}
+
+static const char * _storeString(RomanizationShard * shard, const char * string, const size_t length)
+{
+    ArenaChunk * chunk = shard->arena;
+    if (chunk == NULL || chunk->capacity - chunk->used < length + 1)
+    {
+        const size_t capacity = ARENA_CHUNK_SIZE < length + 1 ? length + 1 : ARENA_CHUNK_SIZE;
+        chunk = malloc(sizeof(ArenaChunk) + capacity);
+        if (chunk == NULL)
+        {
+            abort();
+        }
+        chunk->next = shard->arena;
+        chunk->used = 0;
+        chunk->capacity = capacity;
+        shard->arena = chunk;
+    }
+    char * copy = chunk->data + chunk->used;
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    chunk->used += length + 1;
+    return copy;
+}
+
+/**
+ * Returns the slot of the key, or the empty slot where it would be inserted.
+ */
+static CachedRomanization * _findSlot(CachedRomanization * entries, const size_t capacity, const Hash hash, const char * language, const char * scheme, const boolean isDeromanization, const char * input)
+{
+    for (size_t k = hash & (capacity - 1);; k = (k + 1) & (capacity - 1))
+    {
+        CachedRomanization * entry = &entries[k];
+        if (entry->input == NULL || (entry->hash == hash && entry->isDeromanization == isDeromanization && strcmp(entry->language, language) == 0 && strcmp(entry->scheme, scheme) == 0 && strcmp(entry->input, input) == 0))
+        {
+            return entry;
+        }
+    }
+}
+
+static void _growShard(RomanizationShard * shard)
+{
+    const size_t capacity = shard->capacity == 0 ? INITIAL_CAPACITY : 2 * shard->capacity;
+    CachedRomanization * entries = calloc(capacity, sizeof(CachedRomanization));
+    if (entries == NULL)
+    {
+        abort();
+    }
+    for (size_t k = 0; k < shard->capacity; ++k)
+    {
+        const CachedRomanization * entry = &shard->entries[k];
+        if (entry->input != NULL)
+        {
+            *_findSlot(entries, capacity, entry->hash, entry->language, entry->scheme, entry->isDeromanization, entry->input) = *entry;
+        }
+    }
+    free(shard->entries);
+    shard->entries = entries;
+    shard->capacity = capacity;
+}
+
+/**
+ * Returns the conversion of the input (cached), either its romanization or its
+ * deromanization.
+ */
+static const char * _convert(RomanizationCache * cache, const char * language, const char * scheme, const boolean isDeromanization, const char * input)
+{
+    StringBuilder * scratch = _getScratch();
+    const char * schemeKey = scheme == NULL ? "" : scheme;
+    const Hash hash = hashString(hashString(hashString(hashString(HASH_SEED, isDeromanization ? "<" : ">"), language), schemeKey), input);
+    // The low bits pick the slot, so the shard is picked by the high ones.
+    RomanizationShard * shard = &cache->shards[hash >> 60 & (SHARD_COUNT - 1)];
+
+    pthread_mutex_lock(&shard->lock);
+    if (shard->capacity != 0)
+    {
+        const CachedRomanization * entry = _findSlot(shard->entries, shard->capacity, hash, language, schemeKey, isDeromanization, input);
+        if (entry->input != NULL)
+        {
+            ++shard->hits;
+            pthread_mutex_unlock(&shard->lock);
+            return entry->romanization;
+        }
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    // Other tasks can use the shard while this one romanizes.
+    clearStringBuilder(scratch);
+    if (isDeromanization)
+    {
+        appendDeromanization(scratch, language, scheme, input);
+    }
+    else
+    {
+        appendRomanization(scratch, language, scheme, input);
+    }
+    const char * romanization = peekStringBuilder(scratch);
+
+    pthread_mutex_lock(&shard->lock);
+    ++shard->misses;
+    if (4 * shard->count >= 3 * shard->capacity)
+    {
+        _growShard(shard);
+    }
+    CachedRomanization * entry = _findSlot(shard->entries, shard->capacity, hash, language, schemeKey, isDeromanization, input);
+    if (entry->input == NULL)
+    {
+        // The same key may have been romanized by another task meanwhile.
+        entry->hash = hash;
+        entry->isDeromanization = isDeromanization;
+        entry->language = _storeString(shard, language, strlen(language));
+        entry->scheme = _storeString(shard, schemeKey, strlen(schemeKey));
+        entry->input = _storeString(shard, input, strlen(input));
+        entry->romanization = _storeString(shard, romanization, scratch->length);
+        ++shard->count;
+    }
+    romanization = entry->romanization;
+    pthread_mutex_unlock(&shard->lock);
+    return romanization;
+}
+
+/* PUBLIC FUNCTIONS */
+
+RomanizationCache * createRomanizationCache()
+{
+    RomanizationCache * cache = calloc(1, sizeof(RomanizationCache));
+    for (size_t k = 0; k < SHARD_COUNT; ++k)
+    {
+        pthread_mutex_init(&cache->shards[k].lock, NULL);
+    }
+    return cache;
+}
+
+void destroyRomanizationCache(RomanizationCache * cache)
+{
+    if (cache == NULL)
+    {
+        return;
+    }
+    for (size_t k = 0; k < SHARD_COUNT; ++k)
+    {
+        RomanizationShard * shard = &cache->shards[k];
+        while (shard->arena != NULL)
+        {
+            ArenaChunk * next = shard->arena->next;
+            free(shard->arena);
+            shard->arena = next;
+        }
+        free(shard->entries);
+        pthread_mutex_destroy(&shard->lock);
+    }
+    free(cache);
+}
+
+const char * getRomanization(RomanizationCache * cache, const char * language, const char * scheme, const char * input)
+{
+    return _convert(cache, language, scheme, false, input);
+}
+
+const char * getDeromanization(RomanizationCache * cache, const char * language, const char * scheme, const char * input)
+{
+    return _convert(cache, language, scheme, true, input);
+}
+
+RomanizationCacheStatistics getRomanizationCacheStatistics(RomanizationCache * cache)
+{
+    RomanizationCacheStatistics statistics = {0};
+    for (size_t k = 0; k < SHARD_COUNT; ++k)
+    {
+        RomanizationShard * shard = &cache->shards[k];
+        pthread_mutex_lock(&shard->lock);
+        statistics.hits += shard->hits;
+        statistics.misses += shard->misses;
+        for (ArenaChunk * chunk = shard->arena; chunk != NULL; chunk = chunk->next)
+        {
+            statistics.bytes += chunk->used;
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return statistics;
+}
+
+void logRomanizationCacheStatistics(RomanizationCache * cache)
+{
+    const RomanizationCacheStatistics statistics = getRomanizationCacheStatistics(cache);
+    logDebugging(_logger, "Romanizations: %zu hits, %zu misses (%zu bytes cached).", statistics.hits, statistics.misses, statistics.bytes);
+}
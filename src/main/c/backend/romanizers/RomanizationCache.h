@@ -0,0 +1,60 @@
+#ifndef ROMANIZATION_CACHE_HEADER
+#define ROMANIZATION_CACHE_HEADER
+
+#include "../../shared/Hash.h"
+#include "../../shared/Logger.h"
+#include "../../shared/StringBuilder.h"
+#include "../../shared/Type.h"
+#include "romanize.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * A memo of the romanizations of a compilation (and of their inverses), keyed
+ * by language, scheme and input.
+ * The romanizations are owned by the cache (in an arena), and they are valid
+ * until it's destroyed. It can be shared by parallel generation tasks.
+ */
+typedef struct RomanizationCache RomanizationCache;
+
+/**
+ * The effectiveness of a cache so far.
+ */
+typedef struct {
+    size_t hits;
+    size_t misses;
+    // The bytes of the strings held by the arena of the cache.
+    size_t bytes;
+} RomanizationCacheStatistics;
+
+/** Initialize module's internal state. */
+void initializeRomanizationCacheModule();
+
+/** Shutdown module's internal state. */
+void shutdownRomanizationCacheModule();
+
+RomanizationCache * createRomanizationCache();
+
+void destroyRomanizationCache(RomanizationCache * cache);
+
+/**
+ * Returns the romanization of the input (with the scheme, or the default one
+ * if NULL), computing it only the first time. The result belongs to the cache,
+ * so it must not be freed.
+ */
+const char * getRomanization(RomanizationCache * cache, const char * language, const char * scheme, const char * input);
+
+/**
+ * Analog to "getRomanization", but the input is romanized with the scheme, and
+ * it's converted into the native script of the language (see
+ * "appendDeromanization").
+ */
+const char * getDeromanization(RomanizationCache * cache, const char * language, const char * scheme, const char * input);
+
+RomanizationCacheStatistics getRomanizationCacheStatistics(RomanizationCache * cache);
+
+/** Logs the statistics of the cache, as a debugging trace. */
+void logRomanizationCacheStatistics(RomanizationCache * cache);
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef ROMANIZATION_TABLES_HEADER
+#define ROMANIZATION_TABLES_HEADER
+
+#include <stdint.h>
+
+/** The longest input sequence of any rule, in codepoints. */
+#define TRANSLITERATION_MAXIMUM_DEPTH 8
+
+/**
+ * The word context a rule requires, as flags. A rule with both flags only
+ * applies to a whole word.
+ */
+typedef enum {
+	CONTEXT_ANY = 0,
+	// The input starts a word.
+	CONTEXT_INITIAL = 1,
+	// The input ends a word.
+	CONTEXT_FINAL = 2
+} TransliterationContext;
+
+/**
+ * The output of a rule, as a slice of the blob of its table.
+ */
+typedef struct {
+	uint16_t offset;
+	uint16_t length;
+	uint8_t context;
+} TransliterationRule;
+
+/**
+ * A node of the trie, reached by the input sequence of its path. The children
+ * are contiguous and sorted by key, and the rules that end here are sorted
+ * from the most specific context to the least one.
+ */
+typedef struct {
+	uint32_t firstChild;
+	uint32_t firstRule;
+	uint16_t childCount;
+	uint16_t ruleCount;
+} TransliterationNode;
+
+/**
+ * The rules of a language, compiled into a trie. The roots are indexed
+ * directly by codepoint (from "first", with zero for no root, and the node
+ * index plus one otherwise), so the first step of every match is a lookup.
+ */
+typedef struct {
+	uint32_t first;
+	uint32_t count;
+	const uint32_t * roots;
+	const TransliterationNode * nodes;
+	const uint32_t * keys;
+	const TransliterationRule * rules;
+	const char * blob;
+	unsigned int depth;
+} TransliterationTable;
+
+/**
+ * A romanization of a language, by the code of the language (as written in the
+ * "lang" parameter) and the name of the scheme. The inverse table, if any,
+ * converts the romanized text back into the native script.
+ */
+typedef struct {
+	const char * language;
+	const char * scheme;
+	const TransliterationTable * table;
+	const TransliterationTable * inverse;
+} RomanizationScheme;
+
+/**
+ * The tables are generated at build time (see "RomanizationTableGenerator")
+ * from the rules of "src/main/resources/romanization", as listed in its
+ * "schemes.tsv" and "inverses.tsv". The first scheme of every language is
+ * its default one, and the last entry is all zeros.
+ */
+extern const RomanizationScheme romanizationSchemes[];
+
+#endif
@@ -0,0 +1,261 @@
+#include "ScriptClassifier.h"
+#include "../../shared/Utf8.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+/** The number of codepoints that are decoded at once. */
+#define SCRIPT_WINDOW 256
+
+#define SCRIPT_BIT(script) (1u << (script))
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+    Script script;
+} ScriptRange;
+
+typedef struct {
+    const char * language;
+    unsigned int scripts;
+    const char * names;
+} LanguageScripts;
+
+// The blocks of every script, sorted. Any codepoint out of them is in another one.
+static const ScriptRange _ranges[] = {
+    {0x00000, 0x000BF, SCRIPT_NEUTRAL},
+    {0x000C0, 0x000D6, SCRIPT_LATIN},
+    {0x000D7, 0x000D7, SCRIPT_NEUTRAL},
+    {0x000D8, 0x000F6, SCRIPT_LATIN},
+    {0x000F7, 0x000F7, SCRIPT_NEUTRAL},
+    {0x000F8, 0x002AF, SCRIPT_LATIN},
+    {0x002B0, 0x0036F, SCRIPT_NEUTRAL},
+    {0x00370, 0x003FF, SCRIPT_GREEK},
+    {0x00400, 0x0052F, SCRIPT_CYRILLIC},
+    {0x00590, 0x005FF, SCRIPT_HEBREW},
+    {0x010A0, 0x010FF, SCRIPT_GEORGIAN},
+    {0x01100, 0x011FF, SCRIPT_HANGUL},
+    {0x01C80, 0x01C8F, SCRIPT_CYRILLIC},
+    {0x01C90, 0x01CBF, SCRIPT_GEORGIAN},
+    {0x01E00, 0x01EFF, SCRIPT_LATIN},
+    {0x01F00, 0x01FFF, SCRIPT_GREEK},
+    {0x02000, 0x02BFF, SCRIPT_NEUTRAL},
+    {0x02D00, 0x02D2F, SCRIPT_GEORGIAN},
+    {0x02DE0, 0x02DFF, SCRIPT_CYRILLIC},
+    {0x02E00, 0x02E7F, SCRIPT_NEUTRAL},
+    {0x02E80, 0x02FDF, SCRIPT_HAN},
+    {0x03000, 0x0303F, SCRIPT_NEUTRAL},
+    {0x03040, 0x030FF, SCRIPT_KANA},
+    {0x03130, 0x0318F, SCRIPT_HANGUL},
+    {0x031F0, 0x031FF, SCRIPT_KANA},
+    {0x03400, 0x04DBF, SCRIPT_HAN},
+    {0x04E00, 0x09FFF, SCRIPT_HAN},
+    {0x0A640, 0x0A69F, SCRIPT_CYRILLIC},
+    {0x0A960, 0x0A97F, SCRIPT_HANGUL},
+    {0x0AC00, 0x0D7FF, SCRIPT_HANGUL},
+    {0x0F900, 0x0FAFF, SCRIPT_HAN},
+    {0x0FB1D, 0x0FB4F, SCRIPT_HEBREW},
+    {0x0FE00, 0x0FE0F, SCRIPT_NEUTRAL},
+    {0x0FE30, 0x0FE4F, SCRIPT_NEUTRAL},
+    {0x0FF00, 0x0FF65, SCRIPT_NEUTRAL},
+    {0x0FF66, 0x0FF9F, SCRIPT_KANA},
+    {0x0FFA0, 0x0FFDC, SCRIPT_HANGUL},
+    {0x0FFE0, 0x0FFFF, SCRIPT_NEUTRAL},
+    {0x1F000, 0x1FAFF, SCRIPT_NEUTRAL},
+    {0x20000, 0x3FFFF, SCRIPT_HAN}
+};
+
+#define SCRIPT_RANGE_COUNT (sizeof(_ranges) / sizeof(_ranges[0]))
+
+static const char * _names[] = {
+    "neutral", "Latin", "Greek", "Cyrillic", "Georgian", "Hebrew", "Hangul", "Kana", "Han", "another script"
+};
+
+// Korean can be written with Hanja, and Japanese with Kanji.
+static const LanguageScripts _languages[] = {
+    {"ko", SCRIPT_BIT(SCRIPT_HANGUL) | SCRIPT_BIT(SCRIPT_HAN), "Hangul or Han"},
+    {"ru", SCRIPT_BIT(SCRIPT_CYRILLIC), "Cyrillic"},
+    {"uk", SCRIPT_BIT(SCRIPT_CYRILLIC), "Cyrillic"},
+    {"el", SCRIPT_BIT(SCRIPT_GREEK), "Greek"},
+    {"ja", SCRIPT_BIT(SCRIPT_KANA) | SCRIPT_BIT(SCRIPT_HAN), "Kana or Han"},
+    {"ka", SCRIPT_BIT(SCRIPT_GEORGIAN), "Georgian"},
+    {"he", SCRIPT_BIT(SCRIPT_HEBREW), "Hebrew"},
+    {"zh", SCRIPT_BIT(SCRIPT_HAN), "Han"},
+    {NULL, 0, NULL}
+};
+
+/**
+ * The ranges of a language: the accepted ones (neutral or in its scripts,
+ * merged when adjacent), and the ones in its scripts.
+ */
+typedef struct {
+    unsigned int scripts;
+    uint32_t accepted[SCRIPT_RANGE_COUNT][2];
+    size_t acceptedCount;
+    uint32_t native[SCRIPT_RANGE_COUNT][2];
+    size_t nativeCount;
+    // The span being extended, if no codepoint of the language came after it.
+    boolean isSpanOpen;
+    Script openScript;
+} ScriptClassifier;
+
+/* PRIVATE FUNCTIONS */
+
+static const LanguageScripts * _findLanguage(const char * lang) {
+    for (const LanguageScripts * candidate = _languages; lang != NULL && candidate->language != NULL; ++candidate) {
+        if (strcmp(candidate->language, lang) == 0) {
+            return candidate;
+        }
+    }
+    return NULL;
+}
+
+static void _addRange(uint32_t ranges[][2], size_t * count, const ScriptRange * range) {
+    if (*count != 0 && ranges[*count - 1][1] + 1 == range->first) {
+        ranges[*count - 1][1] = range->last;
+        return;
+    }
+    ranges[*count][0] = range->first;
+    ranges[*count][1] = range->last;
+    ++*count;
+}
+
+static void _beginClassification(ScriptClassifier * classifier, unsigned int scripts) {
+    classifier->scripts = scripts;
+    classifier->acceptedCount = 0;
+    classifier->nativeCount = 0;
+    classifier->isSpanOpen = false;
+    classifier->openScript = SCRIPT_NEUTRAL;
+    for (size_t k = 0; k < SCRIPT_RANGE_COUNT; ++k) {
+        const unsigned int bit = SCRIPT_BIT(_ranges[k].script);
+        if (_ranges[k].script == SCRIPT_NEUTRAL || (scripts & bit) != 0) {
+            _addRange(classifier->accepted, &classifier->acceptedCount, &_ranges[k]);
+        }
+        if ((scripts & bit) != 0) {
+            _addRange(classifier->native, &classifier->nativeCount, &_ranges[k]);
+        }
+    }
+}
+
+// Classifies a codepoint that was not accepted in bulk (or the ones left over).
+static void _classify(ScriptClassifier * classifier, ScriptReport * report, uint32_t c, size_t offset) {
+    const Script script = classifyCodepoint(c);
+    if (script == SCRIPT_NEUTRAL) {
+        return;
+    }
+    if ((classifier->scripts & SCRIPT_BIT(script)) != 0) {
+        report->hasLanguageScript = true;
+        classifier->isSpanOpen = false;
+        return;
+    }
+    if (classifier->isSpanOpen && classifier->openScript == script) {
+        if (report->spanCount <= MAXIMUM_SCRIPT_SPANS) {
+            report->spans[report->spanCount - 1].last = offset + 1;
+        }
+        return;
+    }
+    if (report->spanCount < MAXIMUM_SCRIPT_SPANS) {
+        report->spans[report->spanCount] = (ScriptSpan) {script, offset, offset + 1};
+    }
+    ++report->spanCount;
+    classifier->isSpanOpen = true;
+    classifier->openScript = script;
+}
+
+#if defined(__SSE2__)
+/**
+ * Returns the mask of the 4 codepoints that are in any of the ranges. The
+ * codepoints never reach the sign bit, so the signed comparisons are enough.
+ */
+static int _matchRanges(const __m128i codepoints, const __m128i * lows, const __m128i * highs, size_t count) {
+    __m128i matched = _mm_setzero_si128();
+    for (size_t k = 0; k < count; ++k) {
+        const __m128i isAbove = _mm_cmpgt_epi32(codepoints, lows[k]);
+        const __m128i isBelow = _mm_cmplt_epi32(codepoints, highs[k]);
+        matched = _mm_or_si128(matched, _mm_and_si128(isAbove, isBelow));
+    }
+    return _mm_movemask_ps(_mm_castsi128_ps(matched));
+}
+
+static void _loadRanges(const uint32_t ranges[][2], size_t count, __m128i * lows, __m128i * highs) {
+    for (size_t k = 0; k < count; ++k) {
+        lows[k] = _mm_set1_epi32((int) ranges[k][0] - 1);
+        highs[k] = _mm_set1_epi32((int) ranges[k][1] + 1);
+    }
+}
+#endif
+
+/* PUBLIC FUNCTIONS */
+
+Script classifyCodepoint(uint32_t c) {
+    size_t low = 0;
+    size_t high = SCRIPT_RANGE_COUNT;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (_ranges[middle].last < c) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low < SCRIPT_RANGE_COUNT && _ranges[low].first <= c ? _ranges[low].script : SCRIPT_OTHER;
+}
+
+const char * getScriptName(Script script) {
+    return _names[script];
+}
+
+const char * getLanguageScriptNames(const char * lang) {
+    const LanguageScripts * language = _findLanguage(lang);
+    return language == NULL ? NULL : language->names;
+}
+
+boolean checkScripts(ScriptReport * report, const char * lang, const char * text) {
+    memset(report, 0, sizeof(ScriptReport));
+    const LanguageScripts * language = _findLanguage(lang);
+    if (language == NULL) {
+        return false;
+    }
+    ScriptClassifier classifier;
+    _beginClassification(&classifier, language->scripts);
+#if defined(__SSE2__)
+    __m128i acceptedLows[SCRIPT_RANGE_COUNT];
+    __m128i acceptedHighs[SCRIPT_RANGE_COUNT];
+    __m128i nativeLows[SCRIPT_RANGE_COUNT];
+    __m128i nativeHighs[SCRIPT_RANGE_COUNT];
+    _loadRanges(classifier.accepted, classifier.acceptedCount, acceptedLows, acceptedHighs);
+    _loadRanges(classifier.native, classifier.nativeCount, nativeLows, nativeHighs);
+#endif
+    const size_t length = text == NULL ? 0 : strlen(text);
+    uint32_t codepoints[SCRIPT_WINDOW];
+    size_t consumed = 0;
+    for (size_t offset = 0; offset < length; offset += consumed) {
+        const size_t count = decodeUtf8(text + offset, length - offset, codepoints, SCRIPT_WINDOW, &consumed);
+        size_t k = 0;
+#if defined(__SSE2__)
+        // A block of the language (or neutral) only matters if it ends a span, or it's the first of the language.
+        for (; k + 4 <= count; k += 4) {
+            const __m128i block = _mm_loadu_si128((const __m128i *) (codepoints + k));
+            const int accepted = _matchRanges(block, acceptedLows, acceptedHighs, classifier.acceptedCount);
+            if (accepted == 0xF) {
+                if ((!report->hasLanguageScript || classifier.isSpanOpen)
+                        && _matchRanges(block, nativeLows, nativeHighs, classifier.nativeCount) != 0) {
+                    report->hasLanguageScript = true;
+                    classifier.isSpanOpen = false;
+                }
+                continue;
+            }
+            for (size_t j = k; j < k + 4; ++j) {
+                _classify(&classifier, report, codepoints[j], report->length + j);
+            }
+        }
+#endif
+        for (; k < count; ++k) {
+            _classify(&classifier, report, codepoints[k], report->length + k);
+        }
+        report->length += count;
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef SCRIPT_CLASSIFIER_H
+#define SCRIPT_CLASSIFIER_H
+
+#include "../../shared/Type.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** The most spans in another script that a report keeps (the rest are only counted). */
+#define MAXIMUM_SCRIPT_SPANS 8
+
+/**
+ * The scripts that the romanized languages are written in. ASCII, spaces,
+ * punctuation, symbols and combining marks are neutral, so they fit any
+ * language.
+ */
+typedef enum {
+    SCRIPT_NEUTRAL = 0,
+    SCRIPT_LATIN,
+    SCRIPT_GREEK,
+    SCRIPT_CYRILLIC,
+    SCRIPT_GEORGIAN,
+    SCRIPT_HEBREW,
+    SCRIPT_HANGUL,
+    SCRIPT_KANA,
+    SCRIPT_HAN,
+    SCRIPT_OTHER
+} Script;
+
+/** A run of codepoints in another script, from "first" up to (but excluding) "last". */
+typedef struct {
+    Script script;
+    size_t first;
+    size_t last;
+} ScriptSpan;
+
+/**
+ * The scripts of a text, for a language. A span holds the codepoints in
+ * the same script (other than the ones of the language), and the neutral ones
+ * between them. The offsets are in codepoints.
+ */
+typedef struct {
+    // Whether any codepoint is in a script of the language.
+    boolean hasLanguageScript;
+    size_t length;
+    size_t spanCount;
+    ScriptSpan spans[MAXIMUM_SCRIPT_SPANS];
+} ScriptReport;
+
+/** Returns the script of the codepoint. */
+Script classifyCodepoint(uint32_t c);
+
+/** Returns the (English) name of the script. */
+const char * getScriptName(Script script);
+
+/**
+ * Returns the name of the scripts of the language (as "Hangul or Han"), or
+ * NULL if they are unknown.
+ */
+const char * getLanguageScriptNames(const char * lang);
+
+/**
+ * Classifies the UTF-8 text by the scripts of the language, and returns false
+ * if they are unknown (so nothing can be told). The codepoints are tested
+ * against the ranges of the language in bulk (4 at a time, with SSE2), and
+ * only the ones out of them are classified one by one.
+ */
+boolean checkScripts(ScriptReport * report, const char * lang, const char * text);
+
+#endif
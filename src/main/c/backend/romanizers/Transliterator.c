@@ -0,0 +1,131 @@
+#include "Transliterator.h"
+#include "../../shared/Utf8.h"
+#include <string.h>
+
+#define TRANSLITERATOR_CAPACITY (TRANSLITERATOR_BUFFER + TRANSLITERATION_MAXIMUM_DEPTH + 1)
+
+static const TransliterationNode* _root(const TransliterationTable *table, uint32_t c) {
+    const uint32_t index = c - table->first;
+    if (table->count <= index || table->roots[index] == 0) {
+        return NULL;
+    }
+    return &table->nodes[table->roots[index] - 1];
+}
+
+// The children are sorted by key, so they are binary-searched.
+static const TransliterationNode* _child(const TransliterationTable *table, const TransliterationNode *node, uint32_t c) {
+    size_t low = node->firstChild;
+    size_t high = node->firstChild + node->childCount;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (table->keys[middle] < c) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low < node->firstChild + node->childCount && table->keys[low] == c ? &table->nodes[low] : NULL;
+}
+
+// Every codepoint of the language (even a point or mark) belongs to a word.
+static boolean _isWordCodepoint(const TransliterationTable *table, uint32_t c) {
+    if (c < 128) {
+        return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9');
+    }
+    return _root(table, c) != NULL;
+}
+
+/**
+ * Transliterates the longest match at the position, and returns its length.
+ * Unless the input ended, there are more codepoints available than the depth
+ * of the table, so the codepoint that follows a match is always known.
+ */
+static size_t _step(Transliterator *transliterator, StringBuilder *output, size_t position, size_t available) {
+    const TransliterationTable *table = transliterator->table;
+    const uint32_t *codepoints = transliterator->pending + position;
+    const boolean isInitial = !_isWordCodepoint(table, transliterator->previous);
+    const TransliterationRule *match = NULL;
+    size_t matchLength = 1;
+
+    const TransliterationNode *node = _root(table, codepoints[0]);
+    for (size_t length = 1; node != NULL; ++length) {
+        if (node->ruleCount != 0) {
+            const boolean isFinal = length == available || !_isWordCodepoint(table, codepoints[length]);
+            for (uint32_t k = node->firstRule; k < node->firstRule + node->ruleCount; ++k) {
+                const TransliterationRule *rule = &table->rules[k];
+                if ((!(rule->context & CONTEXT_INITIAL) || isInitial) && (!(rule->context & CONTEXT_FINAL) || isFinal)) {
+                    match = rule;
+                    matchLength = length;
+                    break;
+                }
+            }
+        }
+        if (length == available) {
+            break;
+        }
+        node = _child(table, node, codepoints[length]);
+    }
+
+    if (match != NULL) {
+        appendStringWithLength(output, table->blob + match->offset, match->length);
+    } else if (codepoints[0] < 128) {
+        appendCharacter(output, (char)codepoints[0]);
+    }
+    // Unsupported characters are skipped
+    transliterator->previous = codepoints[matchLength - 1];
+    return matchLength;
+}
+
+// Transliterates the pending codepoints, but the ones a later match could need.
+static void _drain(Transliterator *transliterator, StringBuilder *output, boolean isEnd) {
+    const size_t depth = transliterator->table->depth;
+    size_t position = 0;
+    while (position < transliterator->pendingCount && (isEnd || depth < transliterator->pendingCount - position)) {
+        position += _step(transliterator, output, position, transliterator->pendingCount - position);
+    }
+    transliterator->pendingCount -= position;
+    memmove(transliterator->pending, transliterator->pending + position, transliterator->pendingCount * sizeof(uint32_t));
+}
+
+void beginTransliteration(Transliterator *transliterator, const TransliterationTable *table) {
+    transliterator->table = table;
+    transliterator->pendingCount = 0;
+    transliterator->previous = ' ';
+}
+
+void feedTransliteration(Transliterator *transliterator, StringBuilder *output, const uint32_t *codepoints, size_t count) {
+    while (0 < count) {
+        size_t chunk = TRANSLITERATOR_CAPACITY - transliterator->pendingCount;
+        chunk = count < chunk ? count : chunk;
+        memcpy(transliterator->pending + transliterator->pendingCount, codepoints, chunk * sizeof(uint32_t));
+        transliterator->pendingCount += chunk;
+        codepoints += chunk;
+        count -= chunk;
+        _drain(transliterator, output, false);
+    }
+}
+
+void endTransliteration(Transliterator *transliterator, StringBuilder *output) {
+    _drain(transliterator, output, true);
+}
+
+void transliterate(StringBuilder *output, const TransliterationTable *table, const char *input) {
+    size_t length = strlen(input);
+    reserveStringBuilder(output, length);
+
+    // The input is decoded right after the held codepoints, so it's never copied.
+    // Invalid bytes are decoded as U+FFFD, that no rule matches.
+    Transliterator transliterator;
+    beginTransliteration(&transliterator, table);
+    size_t consumed = 0;
+    for (size_t offset = 0; offset < length; offset += consumed) {
+        const size_t capacity = TRANSLITERATOR_CAPACITY - transliterator.pendingCount;
+        transliterator.pendingCount += decodeUtf8(input + offset, length - offset, transliterator.pending + transliterator.pendingCount, capacity, &consumed);
+        _drain(&transliterator, output, false);
+    }
+    endTransliteration(&transliterator, output);
+}
+
+const TransliterationNode* findTransliterationNode(const TransliterationTable *table, const TransliterationNode *node, uint32_t c) {
+    return node == NULL ? _root(table, c) : _child(table, node, c);
+}
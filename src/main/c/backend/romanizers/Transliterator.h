@@ -0,0 +1,45 @@
+#ifndef TRANSLITERATOR_H
+#define TRANSLITERATOR_H
+
+#include "RomanizationTables.h"
+#include "../../shared/StringBuilder.h"
+#include "../../shared/Type.h"
+#include <stdint.h>
+
+/** The number of codepoints that a transliterator holds at once. */
+#define TRANSLITERATOR_BUFFER 256
+
+/**
+ * Transliterates a stream of codepoints in a single pass: at every position,
+ * the longest rule of the table whose input and context match is applied.
+ * A codepoint that no rule matches is copied if it's ASCII, and dropped
+ * otherwise. Since a match (and its context) looks ahead up to the depth of
+ * the table, that many codepoints are held back until more input arrives.
+ */
+typedef struct {
+    const TransliterationTable * table;
+    uint32_t pending[TRANSLITERATOR_BUFFER + TRANSLITERATION_MAXIMUM_DEPTH + 1];
+    size_t pendingCount;
+    // The last transliterated codepoint, to know whether a word starts.
+    uint32_t previous;
+} Transliterator;
+
+void beginTransliteration(Transliterator * transliterator, const TransliterationTable * table);
+
+/** Appends the transliteration of the codepoints, except the held ones. */
+void feedTransliteration(Transliterator * transliterator, StringBuilder * output, const uint32_t * codepoints, size_t count);
+
+/** Appends the transliteration of the held codepoints, at the end of the input. */
+void endTransliteration(Transliterator * transliterator, StringBuilder * output);
+
+/** Appends the transliteration of the UTF-8 input to the output. */
+void transliterate(StringBuilder * output, const TransliterationTable * table, const char * input);
+
+/**
+ * Returns the child of the node by the codepoint (or the root of the codepoint,
+ * if the node is NULL), or NULL if there isn't any. A custom matcher walks the
+ * trie with it.
+ */
+const TransliterationNode * findTransliterationNode(const TransliterationTable * table, const TransliterationNode * node, uint32_t c);
+
+#endif
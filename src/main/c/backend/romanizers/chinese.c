@@ -0,0 +1,117 @@
+#include "romanize.h"
+#include "PinyinDictionary.h"
+#include <string.h>
+
+/**
+ * The fullwidth punctuation, that is written as its ASCII counterpart. The
+ * closing marks are followed by a space, as in English.
+ */
+typedef struct {
+    uint32_t codepoint;
+    char ascii;
+    boolean spaced;
+} ChinesePunctuation;
+
+static const ChinesePunctuation _punctuation[] = {
+    {0x3001, ',', true}, {0x3002, '.', true}, {0xFF01, '!', true}, {0xFF08, '(', false},
+    {0xFF09, ')', true}, {0xFF0C, ',', true}, {0xFF1A, ':', true}, {0xFF1B, ';', true},
+    {0xFF1F, '?', true}, {0x201C, '"', false}, {0x201D, '"', true}, {0x300A, '"', false},
+    {0x300B, '"', true}
+};
+
+static const ChinesePunctuation *_findPunctuation(uint32_t c) {
+    for (size_t k = 0; k < sizeof(_punctuation) / sizeof(_punctuation[0]); k++) {
+        if (_punctuation[k].codepoint == c) {
+            return &_punctuation[k];
+        }
+    }
+    return NULL;
+}
+
+// The unified ideographs, their extensions, and the compatibility ones.
+static boolean _isIdeograph(uint32_t c) {
+    return (0x3400 <= c && c <= 0x9FFF) || (0xF900 <= c && c <= 0xFAFF) || (0x20000 <= c && c <= 0x3134F);
+}
+
+static boolean _isAlphanumeric(char c) {
+    return ('a' <= (c | 0x20) && (c | 0x20) <= 'z') || ('0' <= c && c <= '9');
+}
+
+void romanizePinyin(StringBuilder *output, const char *input) {
+    if (!input) return;
+
+    // A character (3 bytes) is read as a syllable of at most 6 bytes, and a space.
+    size_t length = strlen(input);
+    reserveStringBuilder(output, 2 * length + 1);
+
+    // The words are segmented by the longest match, and written apart.
+    char previous = '\0';
+    boolean spaced = false;
+    uint32_t codepoint;
+    size_t consumed = 0;
+    for (size_t offset = 0; offset < length; offset += consumed) {
+        const char *reading = NULL;
+        const unsigned char byte = (unsigned char)input[offset];
+        if (byte < 0x80) {
+            consumed = 1;
+            if (spaced && _isAlphanumeric((char)byte)) {
+                appendCharacter(output, ' ');
+            }
+            appendCharacter(output, (char)byte);
+            previous = (char)byte;
+            spaced = false;
+        } else if ((consumed = matchPinyinWord(input + offset, length - offset, &reading)) != 0) {
+            if (spaced || _isAlphanumeric(previous)) {
+                appendCharacter(output, ' ');
+            }
+            appendString(output, reading);
+            previous = 'a';
+            spaced = true;
+        } else {
+            decodeUtf8(input + offset, length - offset, &codepoint, 1, &consumed);
+            const ChinesePunctuation *punctuation = _findPunctuation(codepoint);
+            if (punctuation != NULL) {
+                appendCharacter(output, punctuation->ascii);
+                previous = punctuation->ascii;
+                spaced = punctuation->spaced;
+            } else if (_isIdeograph(codepoint)) {
+                // A character without a reading is kept, as a word of its own.
+                if (spaced || _isAlphanumeric(previous)) {
+                    appendCharacter(output, ' ');
+                }
+                appendStringWithLength(output, input + offset, consumed);
+                previous = 'a';
+                spaced = true;
+            }
+            // Anything else is dropped, as in other scripts.
+        }
+    }
+}
+
+size_t findMissingPinyinReadings(StringBuilder *missing, const char *input) {
+    size_t count = 0;
+    if (!input) return count;
+
+    const size_t length = strlen(input);
+    uint32_t codepoint;
+    size_t consumed = 0;
+    for (size_t offset = 0; offset < length; offset += consumed) {
+        const char *reading = NULL;
+        if ((unsigned char)input[offset] < 0x80) {
+            consumed = 1;
+        } else if ((consumed = matchPinyinWord(input + offset, length - offset, &reading)) == 0) {
+            decodeUtf8(input + offset, length - offset, &codepoint, 1, &consumed);
+            if (_isIdeograph(codepoint)) {
+                // Every character is listed once (UTF-8 never matches inside another character).
+                char character[5] = {0};
+                memcpy(character, input + offset, consumed);
+                if (strstr(peekStringBuilder(missing), character) == NULL) {
+                    appendCharacter(missing, ' ');
+                    appendString(missing, character);
+                    ++count;
+                }
+            }
+        }
+    }
+    return count;
+}
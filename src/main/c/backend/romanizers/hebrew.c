@@ -1,96 +1,100 @@
 #include "romanize.h"
-#include <stdio.h>
-#include <wchar.h>
-#include <locale.h>
-#include <stdlib.h>
+#include "Transliterator.h"
 #include <string.h>
 
-#define BASE 0x05D0
-#define LAST 0x05EA
-#define MAX_BUF 512
+#define FIRST_CANTILLATION 0x0591
+#define LAST_CANTILLATION 0x05AF
+#define FIRST_POINT 0x05B0
+#define LAST_POINT 0x05C7
+#define FIRST_LETTER 0x05D0
+#define LAST_LETTER 0x05EA
 
-const char *hebrew_table[LAST - BASE + 1] = {
-    "",  "b", "g", "d", "h", "v", "z", "kh", "t", "y",   // א - י
-    "k", "k", "l", "m", "m", "n", "n", "s", "", "p",     // כ - פ
-    "p", "ts", "ts", "k", "r", "sh", "t"                 // צ - ת
-};
+#define DAGESH 0x05BC
+#define METEG 0x05BD
+#define RAFE 0x05BF
+#define SHIN_DOT 0x05C1
+#define SIN_DOT 0x05C2
 
-const char* getHebrewConsonant(uint32_t c) {
-    if (c >= BASE && c <= LAST) {
-        return hebrew_table[c - BASE];
-    }
-    return NULL;
-}
+// The most points a letter keeps; any more are typos.
+#define MAXIMUM_POINTS 4
 
-const char* getHebrewVowel(uint32_t c) {
-    switch (c) {
-        case 0x05B0: return "e"; // Sheva
-        case 0x05B1: case 0x05B2: return "a";
-        case 0x05B3: return "o";
-        case 0x05B4: return "i";
-        case 0x05B5: case 0x05B6: return "e";
-        case 0x05B7: case 0x05B8: return "a";
-        case 0x05B9: return "o";
-        case 0x05BB: return "u";
-        default: return NULL;
+/**
+ * A letter and its points. The points follow it in any order (and possibly
+ * mixed with cantillation marks), but the rules expect a single one, so the
+ * letter is held back until the next base character.
+ */
+typedef struct {
+    uint32_t codepoints[1 + MAXIMUM_POINTS];
+    size_t length;
+} HebrewCluster;
+
+// The rules expect the shin or sin dot first, then the dagesh, then the vowel.
+static int _rankOf(uint32_t point) {
+    switch (point) {
+        case SHIN_DOT: case SIN_DOT: return 0;
+        case DAGESH: return 1;
+        default: return 2;
     }
 }
 
-char *decomposeHebrewChar(uint32_t c) {
-    const char *cons = getHebrewConsonant(c);
-    const char *vowel = getHebrewVowel(c);
+static boolean _isIgnoredMark(uint32_t c) {
+    return (FIRST_CANTILLATION <= c && c <= LAST_CANTILLATION) || c == METEG || c == RAFE;
+}
 
-    if (cons) {
-        char* ret = malloc(6);
-        snprintf(ret, 6, "%s", cons);
-        return ret;
-    }
+static boolean _isPoint(uint32_t c) {
+    return FIRST_POINT <= c && c <= LAST_POINT && !_isIgnoredMark(c);
+}
 
-    if (vowel) {
-        char* ret = malloc(4);  
-        snprintf(ret, 4, "%s", vowel);
-        return ret;
+// Inserts the point in its place (an insertion sort, since there are a few).
+static void _addPoint(HebrewCluster *cluster, uint32_t point) {
+    if (1 + MAXIMUM_POINTS <= cluster->length) {
+        return;
     }
-
-    if (c < 128) {
-        char* ret = malloc(2);
-        ret[0] = (char)c;
-        ret[1] = '\0';
-        return ret;
+    size_t k = cluster->length++;
+    while (1 < k && _rankOf(point) < _rankOf(cluster->codepoints[k - 1])) {
+        cluster->codepoints[k] = cluster->codepoints[k - 1];
+        --k;
     }
-
-    return NULL;  // Ignore unsupported non-ASCII non-Hebrew characters
+    cluster->codepoints[k] = point;
 }
 
-char* romanizeHebrew(const char* input) {
-    if (!input) return NULL;
+static void _flushCluster(Transliterator *transliterator, StringBuilder *output, HebrewCluster *cluster) {
+    feedTransliteration(transliterator, output, cluster->codepoints, cluster->length);
+    cluster->length = 0;
+}
 
-    char* output = malloc(1024);
-    output[0] = '\0';
+void romanizeHebrew(StringBuilder *output, const TransliterationTable *table, const char* input) {
+    if (!input) return;
 
-    const char* ptr = input;
-    while (*ptr) {
-        const char* saved = ptr;
-        uint32_t c1 = utf8ToUnicode(&ptr);
+    // Every Hebrew letter or point (2 bytes) romanizes to at most 2 characters.
+    size_t length = strlen(input);
+    reserveStringBuilder(output, length);
 
-        // Check for ו + ֹ → "o"
-        if (c1 == 0x05D5) {
-            const char* lookahead = ptr;
-            uint32_t c2 = utf8ToUnicode(&lookahead);
-            if (c2 == 0x05B9) {
-                strcat(output, "o");
-                ptr = lookahead;
+    // The clusters are sorted on the fly, and transliterated by the rules.
+    Transliterator transliterator;
+    beginTransliteration(&transliterator, table);
+    HebrewCluster cluster = {0};
+    uint32_t codepoints[ROMANIZER_WINDOW];
+    size_t consumed = 0;
+    for (size_t offset = 0; offset < length; offset += consumed) {
+        size_t count = decodeUtf8(input + offset, length - offset, codepoints, ROMANIZER_WINDOW, &consumed);
+        for (size_t k = 0; k < count; k++) {
+            const uint32_t c = codepoints[k];
+            if (_isIgnoredMark(c)) {
                 continue;
             }
-        }
-
-        // Otherwise, use decomposer
-        char* romanized = decomposeHebrewChar(c1);
-        if (romanized) {
-            strcat(output, romanized);
-            free(romanized);
+            if (_isPoint(c) && cluster.length != 0) {
+                _addPoint(&cluster, c);
+                continue;
+            }
+            _flushCluster(&transliterator, output, &cluster);
+            cluster.codepoints[cluster.length++] = c;
+            if (c < FIRST_LETTER || LAST_LETTER < c) {
+                // Only letters take points.
+                _flushCluster(&transliterator, output, &cluster);
+            }
         }
     }
-
-    return output;
-}
\ No newline at end of file
+    _flushCluster(&transliterator, output, &cluster);
+    endTransliteration(&transliterator, output);
+}
@@ -0,0 +1,324 @@
+#include "romanize.h"
+#include "Transliterator.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FIRST_SYLLABLE 0xAC00
+#define LAST_SYLLABLE 0xD7A3
+#define FIRST_INITIAL 0x1100
+#define LAST_INITIAL 0x1112
+#define FIRST_MEDIAL 0x1161
+#define LAST_MEDIAL 0x1175
+#define FIRST_FINAL 0x11A8
+#define LAST_FINAL 0x11C2
+#define MEDIALS 21
+#define FINALS 28
+#define SILENT_INITIAL 0x110B
+
+#define FIRST_COMPATIBILITY_CONSONANT 0x3131
+#define LAST_COMPATIBILITY_CONSONANT 0x314E
+#define FIRST_COMPATIBILITY_VOWEL 0x314F
+#define LAST_COMPATIBILITY_VOWEL 0x3163
+
+/**
+ * The conjoining forms of every compatibility consonant, as an initial and as
+ * a final (zero if it has none). Which one it takes depends on its neighbours.
+ */
+static const uint16_t _compatibilityConsonants[][2] = {
+    {0x1100, 0x11A8}, {0x1101, 0x11A9}, {0, 0x11AA}, {0x1102, 0x11AB}, // ㄱ ㄲ ㄳ ㄴ
+    {0, 0x11AC}, {0, 0x11AD}, {0x1103, 0x11AE}, {0x1104, 0}, // ㄵ ㄶ ㄷ ㄸ
+    {0x1105, 0x11AF}, {0, 0x11B0}, {0, 0x11B1}, {0, 0x11B2}, // ㄹ ㄺ ㄻ ㄼ
+    {0, 0x11B3}, {0, 0x11B4}, {0, 0x11B5}, {0, 0x11B6}, // ㄽ ㄾ ㄿ ㅀ
+    {0x1106, 0x11B7}, {0x1107, 0x11B8}, {0x1108, 0}, {0, 0x11B9}, // ㅁ ㅂ ㅃ ㅄ
+    {0x1109, 0x11BA}, {0x110A, 0x11BB}, {0x110B, 0x11BC}, {0x110C, 0x11BD}, // ㅅ ㅆ ㅇ ㅈ
+    {0x110D, 0}, {0x110E, 0x11BE}, {0x110F, 0x11BF}, {0x1110, 0x11C0}, // ㅉ ㅊ ㅋ ㅌ
+    {0x1111, 0x11C1}, {0x1112, 0x11C2} // ㅍ ㅎ
+};
+
+/**
+ * Composes jamo into precomposed syllables (as NFC does), on the fly, and then
+ * decomposes every syllable into its initial, medial and final jamo, since the
+ * rules apply across syllables. The last syllable is held back, since a later
+ * jamo could still join it, and so is a compatibility consonant that follows
+ * an open syllable, until it's known whether it closes that one or starts the
+ * next.
+ */
+typedef struct {
+    uint32_t syllable;
+    uint32_t consonant;
+    uint32_t composed[3 * (ROMANIZER_WINDOW + 1)];
+    size_t count;
+} HangulComposer;
+
+static boolean _isCompatibilityConsonant(uint32_t c) {
+    return FIRST_COMPATIBILITY_CONSONANT <= c && c <= LAST_COMPATIBILITY_CONSONANT;
+}
+
+static uint32_t _initialOf(uint32_t c) {
+    if (_isCompatibilityConsonant(c)) {
+        return _compatibilityConsonants[c - FIRST_COMPATIBILITY_CONSONANT][0];
+    }
+    return FIRST_INITIAL <= c && c <= LAST_INITIAL ? c : 0;
+}
+
+static uint32_t _finalOf(uint32_t c) {
+    if (_isCompatibilityConsonant(c)) {
+        return _compatibilityConsonants[c - FIRST_COMPATIBILITY_CONSONANT][1];
+    }
+    return FIRST_FINAL <= c && c <= LAST_FINAL ? c : 0;
+}
+
+static boolean _isMedial(uint32_t c) {
+    return FIRST_MEDIAL <= c && c <= LAST_MEDIAL;
+}
+
+// A syllable without a final can still take one.
+static boolean _isOpenSyllable(uint32_t c) {
+    return FIRST_SYLLABLE <= c && c <= LAST_SYLLABLE && (c - FIRST_SYLLABLE) % FINALS == 0;
+}
+
+// A lone compatibility consonant is written as an initial, if it can be one.
+static void _emit(HangulComposer *composer, uint32_t c) {
+    if (_isCompatibilityConsonant(c)) {
+        c = _initialOf(c) ? _initialOf(c) : _finalOf(c);
+    }
+    if (FIRST_SYLLABLE <= c && c <= LAST_SYLLABLE) {
+        const uint32_t index = c - FIRST_SYLLABLE;
+        composer->composed[composer->count++] = FIRST_INITIAL + index / (MEDIALS * FINALS);
+        composer->composed[composer->count++] = FIRST_MEDIAL + index % (MEDIALS * FINALS) / FINALS;
+        if (index % FINALS != 0) {
+            composer->composed[composer->count++] = FIRST_FINAL - 1 + index % FINALS;
+        }
+    } else if (c != 0) {
+        composer->composed[composer->count++] = c;
+    }
+}
+
+static void _compose(HangulComposer *composer, uint32_t c) {
+    if (FIRST_COMPATIBILITY_VOWEL <= c && c <= LAST_COMPATIBILITY_VOWEL) {
+        c = FIRST_MEDIAL + (c - FIRST_COMPATIBILITY_VOWEL);
+    }
+    if (composer->consonant != 0) {
+        const uint32_t consonant = composer->consonant;
+        composer->consonant = 0;
+        if (_isMedial(c) && _initialOf(consonant)) {
+            // It starts the next syllable.
+            _emit(composer, composer->syllable);
+            composer->syllable = consonant;
+        } else {
+            // It closes the held syllable.
+            composer->syllable += _finalOf(consonant) - (FIRST_FINAL - 1);
+        }
+    }
+
+    const uint32_t initial = _initialOf(composer->syllable);
+    if (_isMedial(c) && initial) {
+        composer->syllable = FIRST_SYLLABLE + ((initial - FIRST_INITIAL) * MEDIALS + (c - FIRST_MEDIAL)) * FINALS;
+    } else if (_isOpenSyllable(composer->syllable) && _finalOf(c)) {
+        if (_isCompatibilityConsonant(c)) {
+            composer->consonant = c;
+        } else {
+            composer->syllable += c - (FIRST_FINAL - 1);
+        }
+    } else {
+        _emit(composer, composer->syllable);
+        composer->syllable = c;
+    }
+}
+
+// A NUL (that never comes from the input) releases everything held.
+static void _finishComposition(HangulComposer *composer) {
+    _compose(composer, 0);
+}
+
+// Conjoining jamo (U+1100 to U+11FF) and compatibility jamo (U+3130 to U+318F) start with these bytes.
+static boolean _hasJamo(const char *input, size_t length) {
+    for (const char *c = memchr(input, 0xE1, length); c != NULL; c = memchr(c + 1, 0xE1, length - (c + 1 - input))) {
+        if (c + 1 < input + length && 0x84 <= (unsigned char)c[1] && (unsigned char)c[1] <= 0x87) {
+            return true;
+        }
+    }
+    for (const char *c = memchr(input, 0xE3, length); c != NULL; c = memchr(c + 1, 0xE3, length - (c + 1 - input))) {
+        if (c + 1 < input + length && 0x84 <= (unsigned char)c[1] && (unsigned char)c[1] <= 0x86) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void romanizeKorean(StringBuilder *output, const TransliterationTable *table, const char *input) {
+    if (!input) return;
+
+    // Text of ASCII and precomposed syllables is already normalized, so it's only decomposed.
+    size_t length = strlen(input);
+    const boolean hasJamo = _hasJamo(input, length);
+    reserveStringBuilder(output, length);
+    Transliterator transliterator;
+    beginTransliteration(&transliterator, table);
+    HangulComposer composer = {0};
+    uint32_t codepoints[ROMANIZER_WINDOW];
+    size_t consumed = 0;
+    for (size_t offset = 0; offset < length; offset += consumed) {
+        size_t count = decodeUtf8(input + offset, length - offset, codepoints, ROMANIZER_WINDOW, &consumed);
+        for (size_t k = 0; k < count; k++) {
+            if (hasJamo) {
+                _compose(&composer, codepoints[k]);
+            } else {
+                _emit(&composer, codepoints[k]);
+            }
+        }
+        feedTransliteration(&transliterator, output, composer.composed, composer.count);
+        composer.count = 0;
+    }
+    _finishComposition(&composer);
+    feedTransliteration(&transliterator, output, composer.composed, composer.count);
+    endTransliteration(&transliterator, output);
+}
+
+/* DEROMANIZATION */
+
+// Separates syllables that would be read otherwise, as in "han'guk".
+#define SYLLABLE_SEPARATOR '\''
+// The most jamo that a romanization stands for (every final has a few).
+#define MAXIMUM_CANDIDATES 32
+
+typedef enum {
+    INITIAL_SLOT,
+    MEDIAL_SLOT,
+    FINAL_SLOT
+} JamoSlot;
+
+static boolean _isInSlot(uint32_t c, JamoSlot slot) {
+    switch (slot) {
+        case INITIAL_SLOT: return FIRST_INITIAL <= c && c <= LAST_INITIAL;
+        case MEDIAL_SLOT: return _isMedial(c);
+        default: return FIRST_FINAL <= c && c <= LAST_FINAL;
+    }
+}
+
+// The rules of the inverse table list every jamo of a romanization, in order of preference.
+static uint32_t _jamoOf(const TransliterationTable *inverse, const TransliterationNode *node, JamoSlot slot) {
+    for (uint32_t k = node->firstRule; k < node->firstRule + node->ruleCount; k++) {
+        const TransliterationRule *rule = &inverse->rules[k];
+        uint32_t candidates[MAXIMUM_CANDIDATES];
+        size_t consumed = 0;
+        const size_t count = decodeUtf8(inverse->blob + rule->offset, rule->length, candidates, MAXIMUM_CANDIDATES, &consumed);
+        for (size_t j = 0; j < count; j++) {
+            if (_isInSlot(candidates[j], slot)) {
+                return candidates[j];
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Returns the length of the longest romanization of a jamo of the slot that
+ * starts the text (of at most "length" codepoints), or zero, with its jamo.
+ */
+static size_t _matchJamo(const TransliterationTable *inverse, const uint32_t *text, size_t length, JamoSlot slot, uint32_t *jamo) {
+    size_t matched = 0;
+    const TransliterationNode *node = NULL;
+    for (size_t k = 0; k < length; k++) {
+        node = findTransliterationNode(inverse, node, text[k]);
+        if (node == NULL) {
+            break;
+        }
+        const uint32_t candidate = _jamoOf(inverse, node, slot);
+        if (candidate != 0) {
+            matched = k + 1;
+            *jamo = candidate;
+        }
+    }
+    return matched;
+}
+
+// Returns whether the text is exactly the romanization of a jamo of the slot (or empty).
+static boolean _isJamo(const TransliterationTable *inverse, const uint32_t *text, size_t length, JamoSlot slot, uint32_t *jamo) {
+    *jamo = 0;
+    return length == 0 || _matchJamo(inverse, text, length, slot, jamo) == length;
+}
+
+/**
+ * Returns the length of the initial and the medial that start the text, or
+ * zero, with their jamo. The initial is the longest one that a medial follows,
+ * if any, and otherwise the syllable starts with the medial.
+ */
+static size_t _matchOnset(const TransliterationTable *inverse, const uint32_t *text, size_t length, uint32_t *initial, uint32_t *medial) {
+    size_t initialLength;
+    for (size_t limit = length; (initialLength = _matchJamo(inverse, text, limit, INITIAL_SLOT, initial)) != 0; limit = initialLength - 1) {
+        const size_t medialLength = _matchJamo(inverse, text + initialLength, length - initialLength, MEDIAL_SLOT, medial);
+        if (medialLength != 0) {
+            return initialLength + medialLength;
+        }
+    }
+    *initial = SILENT_INITIAL;
+    return _matchJamo(inverse, text, length, MEDIAL_SLOT, medial);
+}
+
+/**
+ * Returns the length of the final that follows a medial (and of a separator
+ * after it), with its jamo, or zero if the syllable is open. The consonants
+ * before the next medial are split so that the next syllable takes as many as
+ * it can, as its initial. At the end of a word, they all close the syllable.
+ */
+static size_t _matchCoda(const TransliterationTable *inverse, const uint32_t *text, size_t length, uint32_t *final) {
+    size_t run = 0;
+    uint32_t jamo;
+    while (run < length && (text[run] == SYLLABLE_SEPARATOR || findTransliterationNode(inverse, NULL, text[run]) != NULL)
+        && _matchJamo(inverse, text + run, length - run, MEDIAL_SLOT, &jamo) == 0) {
+        run++;
+    }
+    const boolean isWordEnd = run == length || (text[run] != SYLLABLE_SEPARATOR && findTransliterationNode(inverse, NULL, text[run]) == NULL);
+    // No final is longer than the depth of the table, so every split is tried in constant time.
+    for (size_t split = 0; split <= run && split <= inverse->depth; split++) {
+        if (!_isJamo(inverse, text, split, FINAL_SLOT, final)) {
+            continue;
+        }
+        if (isWordEnd ? split == run : _isJamo(inverse, text + split, run - split, INITIAL_SLOT, &jamo)) {
+            return split;
+        }
+        if (split < run && text[split] == SYLLABLE_SEPARATOR
+            && (isWordEnd ? split + 1 == run : _isJamo(inverse, text + split + 1, run - split - 1, INITIAL_SLOT, &jamo))) {
+            return split + 1;
+        }
+    }
+    // The rest is left as it is.
+    *final = 0;
+    return _matchJamo(inverse, text, run, FINAL_SLOT, final);
+}
+
+static void _appendCodepoint(StringBuilder *output, uint32_t c) {
+    char bytes[4];
+    appendStringWithLength(output, bytes, encodeUtf8(c, bytes));
+}
+
+void deromanizeKorean(StringBuilder *output, const TransliterationTable *inverse, const char *input) {
+    if (!input) return;
+
+    // Every syllable (3 bytes) takes at least one letter, and the romanization is matched case-insensitively.
+    size_t length = strlen(input);
+    reserveStringBuilder(output, 3 * length);
+    uint32_t *codepoints = malloc(2 * (length + 1) * sizeof(uint32_t));
+    uint32_t *text = codepoints + length + 1;
+    size_t consumed = 0;
+    const size_t count = decodeUtf8(input, length, codepoints, length + 1, &consumed);
+    for (size_t k = 0; k < count; k++) {
+        text[k] = 'A' <= codepoints[k] && codepoints[k] <= 'Z' ? codepoints[k] | 0x20 : codepoints[k];
+    }
+
+    // Every position is matched a bounded number of times (by the depth of the table), so it's linear.
+    for (size_t position = 0; position < count;) {
+        uint32_t initial, medial, final;
+        const size_t onset = _matchOnset(inverse, text + position, count - position, &initial, &medial);
+        if (onset == 0) {
+            _appendCodepoint(output, codepoints[position++]);
+            continue;
+        }
+        position += onset;
+        position += _matchCoda(inverse, text + position, count - position, &final);
+        const uint32_t index = ((initial - FIRST_INITIAL) * MEDIALS + (medial - FIRST_MEDIAL)) * FINALS;
+        _appendCodepoint(output, FIRST_SYLLABLE + index + (final == 0 ? 0 : final - (FIRST_FINAL - 1)));
+    }
+    free(codepoints);
+}
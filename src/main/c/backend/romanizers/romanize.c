@@ -1,93 +1,91 @@
 #include "romanize.h"
+#include "Transliterator.h"
 #include <string.h>
 #include <stdint.h>
 #include <stdlib.h>
 
-char *romanize(const char *lang, const char *input);
-char *genericRomanize(const char* input, size_t max_char_size, char *(*decomposer)(uint32_t));
+// Chinese is read from a dictionary (see "PinyinDictionary.h"), not from rules.
+static const RomanizationScheme _pinyin = {"zh", "pinyin", NULL, NULL};
 
-char *romanize(const char *lang, const char *input)
+const RomanizationScheme *findRomanizationScheme(const char *lang, const char *scheme)
 {
-    if (input == NULL)
-        return " ";
+    if (strcmp(lang, _pinyin.language) == 0)
+    {
+        return scheme == NULL || strcmp(scheme, _pinyin.scheme) == 0 ? &_pinyin : NULL;
+    }
+    // There are a few schemes, so they are scanned (and the romanizations are cached anyway)
+    for (const RomanizationScheme *candidate = romanizationSchemes; candidate->language != NULL; ++candidate)
+    {
+        if (strcmp(candidate->language, lang) == 0 && (scheme == NULL || strcmp(candidate->scheme, scheme) == 0))
+        {
+            return candidate;
+        }
+    }
+    return NULL;
+}
+
+boolean isRomanizationSchemeSupported(const char *lang, const char *scheme)
+{
+    return findRomanizationScheme(lang, scheme) != NULL;
+}
+
+boolean isDeromanizationSupported(const char *lang, const char *scheme)
+{
+    const RomanizationScheme *romanization = findRomanizationScheme(lang, scheme);
+    return romanization != NULL && romanization->inverse != NULL;
+}
 
-    if (strcmp(lang, "ko") == 0)
+char *romanize(const char *lang, const char *scheme, const char *input)
+{
+    StringBuilder output = {0};
+    appendRomanization(&output, lang, scheme, input);
+    return buildString(&output);
+}
+
+void appendRomanization(StringBuilder *output, const char *lang, const char *scheme, const char *input)
+{
+    const RomanizationScheme *romanization = input == NULL ? NULL : findRomanizationScheme(lang, scheme);
+    if (romanization == NULL)
     {
-        return genericRomanize(input, 7, &decomposeHangulChar);
+        // Unsupported language - this is an error
+        appendCharacter(output, ' ');
     }
-    else if (strcmp(lang, "he") == 0)
+    else if (strcmp(lang, "ko") == 0)
+    {
+        // Korean normalizes any jamo, and romanizes the jamo of every syllable
+        romanizeKorean(output, romanization->table, input);
+    }
+    else if (romanization == &_pinyin)
     {
-        // Hebrew is too complex and it needs it's own romanizer
-        return romanizeHebrew(input);
+        // Chinese is segmented into the words of the dictionary
+        romanizePinyin(output, input);
     }
-    else if (strcmp(lang, "ru") == 0)
+    else if (strcmp(lang, "he") == 0)
     {
-        return genericRomanize(input, 4, &decomposeCyrillicChar);
+        // Hebrew sorts the points of every letter before the rules apply
+        romanizeHebrew(output, romanization->table, input);
     }
     else
     {
-        // Unsupported language - this is an error
-        return " ";
+        transliterate(output, romanization->table, input);
     }
 }
 
-uint32_t utf8ToUnicode(const char** str) {
-    const unsigned char* s = (const unsigned char*)*str;
-    uint32_t codepoint = 0;
-    
-    if (s[0] < 0x80) {
-        // ASCII (1 byte)
-        codepoint = s[0];
-        *str += 1;
-    } else if ((s[0] & 0xE0) == 0xC0) {
-        // 2 bytes
-        codepoint = ((s[0] & 0x1F) << 6) | (s[1] & 0x3F);
-        *str += 2;
-    } else if ((s[0] & 0xF0) == 0xE0) {
-        // 3 bytes (aquí están los caracteres coreanos)
-        codepoint = ((s[0] & 0x0F) << 12) | 
-                   ((s[1] & 0x3F) << 6) | 
-                   (s[2] & 0x3F);
-        *str += 3;
-    } else if ((s[0] & 0xF8) == 0xF0) {
-        // 4 bytes
-        codepoint = ((s[0] & 0x07) << 18) | 
-                   ((s[1] & 0x3F) << 12) | 
-                   ((s[2] & 0x3F) << 6) | 
-                   (s[3] & 0x3F);
-        *str += 4;
-    } else {
-        // Byte inválido
-        *str += 1;
-        return 0;
+void appendDeromanization(StringBuilder *output, const char *lang, const char *scheme, const char *input)
+{
+    const RomanizationScheme *romanization = input == NULL ? NULL : findRomanizationScheme(lang, scheme);
+    if (romanization == NULL || romanization->inverse == NULL)
+    {
+        // Without an inverse table, the input is kept as it is
+        appendString(output, input == NULL ? "" : input);
     }
-    
-    return codepoint;
-}
-
-char *genericRomanize(const char* input, size_t max_char_size, char *(*decomposer)(uint32_t)){
-    if (!input) return NULL;
-    
-    size_t input_len = strlen(input);
-    size_t max_output_size = input_len * max_char_size + 1;
-    char* output = malloc(max_output_size);
-    if (!output) return NULL;
-    
-    output[0] = '\0';
-    
-    const char* ptr = input;
-    
-    while (*ptr) {
-        uint32_t codepoint = utf8ToUnicode(&ptr);
-        
-        if (codepoint == 0) continue; // Skip invalid bytes
-        
-        char* romanized = decomposer(codepoint);
-        if (romanized) {
-            strcat(output, romanized);
-            free(romanized);
-        }
+    else if (strcmp(lang, "ko") == 0)
+    {
+        // Korean is parsed into syllables, since a romanization can stand for an initial or a final
+        deromanizeKorean(output, romanization->inverse, input);
+    }
+    else
+    {
+        transliterate(output, romanization->inverse, input);
     }
-    
-    return output;
 }
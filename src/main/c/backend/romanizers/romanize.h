@@ -4,12 +4,58 @@
 #include <wchar.h>
 #include <locale.h>
 #include <stdint.h>
+#include "../../shared/StringBuilder.h"
+#include "../../shared/Type.h"
+#include "../../shared/Utf8.h"
+#include "RomanizationTables.h"
 
-char* romanize(const char* lang, const char * input);
-char* romanizeHebrew(const char* input);
-char* decomposeHangulChar(uint32_t syllable);
-char* decomposeCyrillicChar(uint32_t c);
+/** The number of codepoints that romanizers decode at once. */
+#define ROMANIZER_WINDOW 256
 
-uint32_t utf8ToUnicode(const char** str);
+/**
+ * Returns the romanization of the language with the scheme, or NULL if there
+ * isn't any. Without a scheme (NULL), the default one of the language is used.
+ */
+const RomanizationScheme * findRomanizationScheme(const char * lang, const char * scheme);
+
+/** Returns whether the language can be romanized with the scheme (see "findRomanizationScheme"). */
+boolean isRomanizationSchemeSupported(const char * lang, const char * scheme);
+
+/**
+ * Returns whether text romanized with the scheme can be converted back into
+ * the native script of the language (see "appendDeromanization").
+ */
+boolean isDeromanizationSupported(const char * lang, const char * scheme);
+
+/** Returns the romanization of the input, as a new string that must be freed. */
+char* romanize(const char* lang, const char * scheme, const char * input);
+
+/** Appends the romanization of the input to the output, in a single pass. */
+void appendRomanization(StringBuilder * output, const char * lang, const char * scheme, const char * input);
+
+/**
+ * Appends the input, romanized with the scheme, converted into the native
+ * script of the language, in a single pass: the inverse of the rules of the
+ * scheme is matched greedily, by the longest romanization.
+ */
+void appendDeromanization(StringBuilder * output, const char * lang, const char * scheme, const char * input);
+
+void romanizeHebrew(StringBuilder * output, const TransliterationTable * table, const char* input);
+
+/** Normalizes any jamo into syllables, and romanizes their jamo with the table. */
+void romanizeKorean(StringBuilder * output, const TransliterationTable * table, const char* input);
+
+/** Parses the romanized input into syllables, with the jamo of the inverse table, and writes them in Hangul. */
+void deromanizeKorean(StringBuilder * output, const TransliterationTable * inverse, const char* input);
+
+/** Segments the input into words of the dictionary (see "PinyinDictionary.h"), and writes their pinyin. */
+void romanizePinyin(StringBuilder * output, const char* input);
+
+/**
+ * Appends the characters of the input that have no reading in the dictionary
+ * (that "romanizePinyin" keeps as they are), every one once and after a
+ * space, and returns how many there are.
+ */
+size_t findMissingPinyinReadings(StringBuilder * missing, const char* input);
 
 #endif
\ No newline at end of file
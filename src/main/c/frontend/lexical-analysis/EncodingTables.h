@@ -0,0 +1,35 @@
+#ifndef ENCODING_TABLES_HEADER
+#define ENCODING_TABLES_HEADER
+
+#include <stdint.h>
+
+/**
+ * A legacy encoding of single bytes, and optionally of pairs of bytes (as
+ * EUC-KR). The codepoint of a byte is looked up in "singles", where zero means
+ * that the byte is undefined, or that it leads a pair (but for the NUL byte).
+ * The codepoint of a pair is looked up in "pairs", by its lead and its trail
+ * (from "firstLead" and "firstTrail"), where zero means undefined too.
+ *
+ * The letters are the range of the script that the encoding is used for, that
+ * tells the encodings apart when the input is detected.
+ */
+typedef struct {
+	const char * name;
+	const uint16_t * singles;
+	const uint16_t * pairs;
+	uint8_t firstLead;
+	uint8_t lastLead;
+	uint8_t firstTrail;
+	uint8_t lastTrail;
+	uint32_t firstLetter;
+	uint32_t lastLetter;
+} ByteEncoding;
+
+/**
+ * The tables are generated at build time (see "EncodingTableGenerator") from
+ * the mappings of "src/main/resources/encodings", as listed in its
+ * "encodings.tsv", and the last entry is all zeros.
+ */
+extern const ByteEncoding byteEncodings[];
+
+#endif
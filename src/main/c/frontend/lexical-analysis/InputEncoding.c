@@ -0,0 +1,282 @@
+#include "InputEncoding.h"
+#include <string.h>
+#include <strings.h>
+
+// A legacy encoding is only detected with this many letters, that take this share (in percent) of the non-ASCII bytes.
+#define MINIMUM_LETTERS 4
+#define MINIMUM_LETTER_SHARE 75
+
+/* PRIVATE FUNCTIONS */
+
+static size_t _decodeBytes(const ByteEncoding * encoding, const unsigned char * bytes, const size_t length, uint32_t * codepoint, boolean * isTruncated);
+static size_t _asciiLength(const unsigned char * bytes, const size_t length);
+static boolean _isUtf16(const unsigned char * sample, const size_t length, const size_t high);
+static boolean _scoreEncoding(const ByteEncoding * encoding, const unsigned char * sample, const size_t length, size_t * letters, size_t * others);
+static TranscodingStatus _transcodeUtf8(const char * input, const size_t length, const boolean isEnd, char * output, const size_t capacity, size_t * consumed, size_t * written);
+static TranscodingStatus _transcodeUtf16(const unsigned char * input, const size_t length, const boolean isEnd, const size_t high, char * output, const size_t capacity, size_t * consumed, size_t * written);
+static TranscodingStatus _transcodeBytes(const ByteEncoding * encoding, const unsigned char * input, const size_t length, const boolean isEnd, char * output, const size_t capacity, size_t * consumed, size_t * written);
+
+/**
+ * Decodes the character at the start of the bytes (that is not ASCII), and
+ * returns its length, or zero if it's undefined. In that case, "isTruncated"
+ * tells whether the pair was only cut short by the end of the bytes.
+ */
+static size_t _decodeBytes(const ByteEncoding * encoding, const unsigned char * bytes, const size_t length, uint32_t * codepoint, boolean * isTruncated) {
+	const unsigned char lead = bytes[0];
+	*isTruncated = false;
+	*codepoint = encoding->singles[lead];
+	if (*codepoint != 0) {
+		return 1;
+	}
+	if (encoding->pairs == NULL || lead < encoding->firstLead || encoding->lastLead < lead) {
+		return 0;
+	}
+	if (length < 2) {
+		*isTruncated = true;
+		return 0;
+	}
+	const unsigned char trail = bytes[1];
+	if (trail < encoding->firstTrail || encoding->lastTrail < trail) {
+		return 0;
+	}
+	const size_t trailCount = encoding->lastTrail - encoding->firstTrail + 1;
+	*codepoint = encoding->pairs[(lead - encoding->firstLead) * trailCount + trail - encoding->firstTrail];
+	return *codepoint == 0 ? 0 : 2;
+}
+
+static size_t _asciiLength(const unsigned char * bytes, const size_t length) {
+	size_t k = 0;
+	while (k < length && bytes[k] < 0x80) {
+		++k;
+	}
+	return k;
+}
+
+// Most ASCII units of UTF-16 have a zero high byte (at the offset "high" of every unit), and a low byte that isn't.
+static boolean _isUtf16(const unsigned char * sample, const size_t length, const size_t high) {
+	const size_t units = length / 2;
+	size_t zeroHighs = 0;
+	size_t zeroLows = 0;
+	for (size_t k = 0; k < units; ++k) {
+		zeroHighs += sample[2 * k + high] == 0;
+		zeroLows += sample[2 * k + 1 - high] == 0;
+	}
+	return 2 <= units && units <= 4 * zeroHighs && 8 * zeroLows <= zeroHighs;
+}
+
+/**
+ * Counts the bytes of the sample that decode into letters of the encoding, and
+ * into other non-ASCII characters. Returns false if a byte is undefined.
+ */
+static boolean _scoreEncoding(const ByteEncoding * encoding, const unsigned char * sample, const size_t length, size_t * letters, size_t * others) {
+	*letters = 0;
+	*others = 0;
+	size_t k = 0;
+	while (k < length) {
+		k += _asciiLength(sample + k, length - k);
+		if (k == length) {
+			break;
+		}
+		uint32_t codepoint;
+		boolean isTruncated;
+		const size_t size = _decodeBytes(encoding, sample + k, length - k, &codepoint, &isTruncated);
+		if (size == 0) {
+			// The sample may cut the last pair.
+			return isTruncated;
+		}
+		if (encoding->firstLetter <= codepoint && codepoint <= encoding->lastLetter) {
+			*letters += size;
+		}
+		else {
+			*others += size;
+		}
+		k += size;
+	}
+	return true;
+}
+
+static TranscodingStatus _transcodeUtf8(const char * input, const size_t length, const boolean isEnd, char * output, const size_t capacity, size_t * consumed, size_t * written) {
+	const size_t limit = length < capacity ? length : capacity;
+	const size_t valid = validUtf8Length(input, limit);
+	memcpy(output, input, valid);
+	*consumed = valid;
+	*written = valid;
+	if (valid == limit) {
+		return TRANSCODING_ACCEPT;
+	}
+	if (isTruncatedUtf8(input + valid, limit - valid)) {
+		return limit < length || !isEnd ? TRANSCODING_ACCEPT : TRANSCODING_TRUNCATED;
+	}
+	return TRANSCODING_INVALID;
+}
+
+static TranscodingStatus _transcodeUtf16(const unsigned char * input, const size_t length, const boolean isEnd, const size_t high, char * output, const size_t capacity, size_t * consumed, size_t * written) {
+	const size_t low = 1 - high;
+	TranscodingStatus status = TRANSCODING_ACCEPT;
+	size_t k = 0;
+	size_t w = 0;
+	while (w + UTF8_MAXIMUM_LENGTH <= capacity) {
+		if (length - k < 2) {
+			status = isEnd && k < length ? TRANSCODING_TRUNCATED : TRANSCODING_ACCEPT;
+			break;
+		}
+		uint32_t codepoint = (uint32_t) input[k + high] << 8 | input[k + low];
+		size_t size = 2;
+		if (0xDC00 <= codepoint && codepoint <= 0xDFFF) {
+			status = TRANSCODING_INVALID;
+			break;
+		}
+		if (0xD800 <= codepoint && codepoint <= 0xDBFF) {
+			if (length - k < 4) {
+				status = isEnd ? TRANSCODING_TRUNCATED : TRANSCODING_ACCEPT;
+				break;
+			}
+			const uint32_t trail = (uint32_t) input[k + 2 + high] << 8 | input[k + 2 + low];
+			if (trail < 0xDC00 || 0xDFFF < trail) {
+				status = TRANSCODING_INVALID;
+				break;
+			}
+			codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (trail - 0xDC00);
+			size = 4;
+		}
+		if (codepoint < 0x80) {
+			output[w++] = (char) codepoint;
+		}
+		else {
+			w += encodeUtf8(codepoint, output + w);
+		}
+		k += size;
+	}
+	*consumed = k;
+	*written = w;
+	return status;
+}
+
+static TranscodingStatus _transcodeBytes(const ByteEncoding * encoding, const unsigned char * input, const size_t length, const boolean isEnd, char * output, const size_t capacity, size_t * consumed, size_t * written) {
+	TranscodingStatus status = TRANSCODING_ACCEPT;
+	size_t k = 0;
+	size_t w = 0;
+	while (true) {
+		// Every legacy encoding is ASCII-compatible, so ASCII is copied as it is.
+		const size_t room = capacity - w;
+		const size_t run = _asciiLength(input + k, length - k < room ? length - k : room);
+		memcpy(output + w, input + k, run);
+		k += run;
+		w += run;
+		if (k == length || w + UTF8_MAXIMUM_LENGTH > capacity) {
+			break;
+		}
+		uint32_t codepoint;
+		boolean isTruncated;
+		const size_t size = _decodeBytes(encoding, input + k, length - k, &codepoint, &isTruncated);
+		if (size == 0) {
+			status = !isTruncated ? TRANSCODING_INVALID : isEnd ? TRANSCODING_TRUNCATED : TRANSCODING_ACCEPT;
+			break;
+		}
+		w += encodeUtf8(codepoint, output + w);
+		k += size;
+	}
+	*consumed = k;
+	*written = w;
+	return status;
+}
+
+/* PUBLIC FUNCTIONS */
+
+boolean findInputEncoding(const char * name, InputEncoding * encoding) {
+	encoding->bytes = NULL;
+	if (strcasecmp(name, "utf-8") == 0 || strcasecmp(name, "utf8") == 0) {
+		encoding->type = INPUT_ENCODING_UTF8;
+		return true;
+	}
+	if (strcasecmp(name, "utf-16") == 0 || strcasecmp(name, "utf-16le") == 0) {
+		encoding->type = INPUT_ENCODING_UTF16LE;
+		return true;
+	}
+	if (strcasecmp(name, "utf-16be") == 0) {
+		encoding->type = INPUT_ENCODING_UTF16BE;
+		return true;
+	}
+	for (const ByteEncoding * candidate = byteEncodings; candidate->name != NULL; ++candidate) {
+		if (strcasecmp(name, candidate->name) == 0) {
+			encoding->type = INPUT_ENCODING_BYTES;
+			encoding->bytes = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char * getInputEncodingName(const InputEncoding * encoding) {
+	switch (encoding->type) {
+		case INPUT_ENCODING_UTF16LE:
+			return "utf-16le";
+		case INPUT_ENCODING_UTF16BE:
+			return "utf-16be";
+		case INPUT_ENCODING_BYTES:
+			return encoding->bytes->name;
+		default:
+			return "utf-8";
+	}
+}
+
+size_t readByteOrderMark(const char * bytes, const size_t length, InputEncoding * encoding) {
+	const unsigned char * data = (const unsigned char *) bytes;
+	if (3 <= length && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+		*encoding = (InputEncoding) {INPUT_ENCODING_UTF8, NULL};
+		return 3;
+	}
+	if (2 <= length && data[0] == 0xFF && data[1] == 0xFE) {
+		*encoding = (InputEncoding) {INPUT_ENCODING_UTF16LE, NULL};
+		return 2;
+	}
+	if (2 <= length && data[0] == 0xFE && data[1] == 0xFF) {
+		*encoding = (InputEncoding) {INPUT_ENCODING_UTF16BE, NULL};
+		return 2;
+	}
+	return 0;
+}
+
+void detectInputEncoding(const char * sample, const size_t length, InputEncoding * encoding) {
+	const unsigned char * data = (const unsigned char *) sample;
+	*encoding = (InputEncoding) {INPUT_ENCODING_UTF8, NULL};
+	if (_isUtf16(data, length, 1)) {
+		encoding->type = INPUT_ENCODING_UTF16LE;
+		return;
+	}
+	if (_isUtf16(data, length, 0)) {
+		encoding->type = INPUT_ENCODING_UTF16BE;
+		return;
+	}
+	const size_t valid = validUtf8Length(sample, length);
+	if (valid == length || isTruncatedUtf8(sample + valid, length - valid)) {
+		return;
+	}
+	size_t bestLetters = 0;
+	for (const ByteEncoding * candidate = byteEncodings; candidate->name != NULL; ++candidate) {
+		size_t letters;
+		size_t others;
+		if (!_scoreEncoding(candidate, data, length, &letters, &others)) {
+			continue;
+		}
+		const boolean isLikely = MINIMUM_LETTERS <= letters && (letters + others) * MINIMUM_LETTER_SHARE <= letters * 100;
+		if (isLikely && bestLetters < letters) {
+			bestLetters = letters;
+			*encoding = (InputEncoding) {INPUT_ENCODING_BYTES, candidate};
+		}
+	}
+}
+
+TranscodingStatus transcodeInput(const InputEncoding * encoding, const char * input, const size_t length, const boolean isEnd,
+		char * output, const size_t capacity, size_t * consumed, size_t * written) {
+	switch (encoding->type) {
+		case INPUT_ENCODING_UTF16LE:
+			return _transcodeUtf16((const unsigned char *) input, length, isEnd, 1, output, capacity, consumed, written);
+		case INPUT_ENCODING_UTF16BE:
+			return _transcodeUtf16((const unsigned char *) input, length, isEnd, 0, output, capacity, consumed, written);
+		case INPUT_ENCODING_BYTES:
+			return _transcodeBytes(encoding->bytes, (const unsigned char *) input, length, isEnd, output, capacity, consumed, written);
+		default:
+			return _transcodeUtf8(input, length, isEnd, output, capacity, consumed, written);
+	}
+}
@@ -0,0 +1,71 @@
+#ifndef INPUT_ENCODING_HEADER
+#define INPUT_ENCODING_HEADER
+
+#include "../../shared/Type.h"
+#include "../../shared/Utf8.h"
+#include "EncodingTables.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** The most bytes that a codepoint takes in UTF-8. */
+#define UTF8_MAXIMUM_LENGTH 4
+
+typedef enum {
+	INPUT_ENCODING_UTF8,
+	INPUT_ENCODING_UTF16LE,
+	INPUT_ENCODING_UTF16BE,
+	// A legacy encoding, from "byteEncodings".
+	INPUT_ENCODING_BYTES
+} InputEncodingType;
+
+typedef struct {
+	InputEncodingType type;
+	const ByteEncoding * bytes;
+} InputEncoding;
+
+typedef enum {
+	// Every byte consumed was transcoded, and the rest needs more input or more room.
+	TRANSCODING_ACCEPT,
+	// The next byte is not valid in the encoding.
+	TRANSCODING_INVALID,
+	// The input ends within a character.
+	TRANSCODING_TRUNCATED
+} TranscodingStatus;
+
+/**
+ * Finds the encoding by its name: "utf-8", "utf-16" (little-endian, unless a
+ * byte order mark tells otherwise), "utf-16le", "utf-16be", or the name of a
+ * legacy one (see "EncodingTables.h"), in any case.
+ */
+boolean findInputEncoding(const char * name, InputEncoding * encoding);
+
+/** Returns the name of the encoding. */
+const char * getInputEncodingName(const InputEncoding * encoding);
+
+/**
+ * Returns the length of the byte order mark that starts the bytes (of UTF-8
+ * or UTF-16), and sets the encoding that it tells, or zero if there isn't any.
+ */
+size_t readByteOrderMark(const char * bytes, const size_t length, InputEncoding * encoding);
+
+/**
+ * Guesses the encoding of a sample of the beginning of the input (without a
+ * byte order mark). UTF-16 has a zero byte in most of its (ASCII) units, and
+ * UTF-8 is well-formed. Otherwise, the sample is decoded with every legacy
+ * encoding, and the one that yields the most letters of its script wins, if
+ * there are enough of them, and few other characters. If nothing fits, the
+ * input is taken as UTF-8, so it's reported as invalid.
+ */
+void detectInputEncoding(const char * sample, const size_t length, InputEncoding * encoding);
+
+/**
+ * Transcodes the input into UTF-8, until it ends, the output has no room for
+ * another character, or an invalid byte is found. The number of bytes read and
+ * written are stored in "consumed" and "written". A character split by the end
+ * of the input is left for the next call, unless "isEnd" tells that no more
+ * input will come. ASCII runs are copied as they are.
+ */
+TranscodingStatus transcodeInput(const InputEncoding * encoding, const char * input, const size_t length, const boolean isEnd,
+	char * output, const size_t capacity, size_t * consumed, size_t * written);
+
+#endif
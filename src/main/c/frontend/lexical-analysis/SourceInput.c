@@ -0,0 +1,142 @@
+#include "SourceInput.h"
+
+/* MODULE INTERNAL STATE */
+
+static Logger * _logger = NULL;
+
+// The encoding of the source, and whether it's detected from the first chunk.
+static InputEncoding _encoding = {INPUT_ENCODING_UTF8, NULL};
+static boolean _isDetected = true;
+static boolean _isStarted = false;
+
+// The source read but not transcoded yet, from "_rawStart" to "_rawEnd".
+static char _raw[SOURCE_INPUT_CHUNK];
+static size_t _rawStart = 0;
+static size_t _rawEnd = 0;
+static boolean _isEnd = false;
+
+// Whether the last character was a CR, so a LF right after it is dropped.
+static boolean _isAfterCarriageReturn = false;
+
+// The offset (in bytes of the source) of the next character, and whether the source is invalid.
+static size_t _offset = 0;
+static boolean _isInvalid = false;
+
+void initializeSourceInputModule() {
+	_logger = createLogger("SourceInput");
+	_encoding = (InputEncoding) {INPUT_ENCODING_UTF8, NULL};
+	_isDetected = true;
+	_isStarted = false;
+	_rawStart = 0;
+	_rawEnd = 0;
+	_isEnd = false;
+	_isAfterCarriageReturn = false;
+	_offset = 0;
+	_isInvalid = false;
+}
+
+void shutdownSourceInputModule() {
+	if (_logger != NULL) {
+		destroyLogger(_logger);
+	}
+}
+
+/* PRIVATE FUNCTIONS */
+
+static void _fill(FILE * source);
+static void _start(FILE * source);
+static size_t _normalizeNewlines(char * buffer, const size_t length);
+
+// Moves the rest of the source to the start of the buffer, and reads after it.
+static void _fill(FILE * source) {
+	const size_t rest = _rawEnd - _rawStart;
+	memmove(_raw, _raw + _rawStart, rest);
+	_rawStart = 0;
+	_rawEnd = rest + fread(_raw + rest, 1, SOURCE_INPUT_CHUNK - rest, source);
+	_isEnd = feof(source) || ferror(source);
+}
+
+// Reads the first chunk, and settles the encoding with its byte order mark, or its content.
+static void _start(FILE * source) {
+	_isStarted = true;
+	_fill(source);
+	InputEncoding marked;
+	const size_t mark = readByteOrderMark(_raw, _rawEnd, &marked);
+	if (mark != 0 && (_isDetected || _encoding.type != INPUT_ENCODING_BYTES)) {
+		_encoding = marked;
+		_rawStart = mark;
+		_offset = mark;
+	}
+	else if (_isDetected) {
+		detectInputEncoding(_raw, _rawEnd, &_encoding);
+	}
+	if (_encoding.type != INPUT_ENCODING_UTF8) {
+		logInformation(_logger, "Reading the input as %s%s.", getInputEncodingName(&_encoding), _isDetected ? " (detected)" : "");
+	}
+	else {
+		logDebugging(_logger, "Reading the input as utf-8.");
+	}
+}
+
+// Turns every CRLF and lone CR into a LF, in place, and returns the new length.
+static size_t _normalizeNewlines(char * buffer, const size_t length) {
+	if (!_isAfterCarriageReturn && memchr(buffer, '\r', length) == NULL) {
+		return length;
+	}
+	size_t w = 0;
+	for (size_t k = 0; k < length; ++k) {
+		if (buffer[k] == '\n' && _isAfterCarriageReturn) {
+			_isAfterCarriageReturn = false;
+			continue;
+		}
+		_isAfterCarriageReturn = buffer[k] == '\r';
+		buffer[w++] = _isAfterCarriageReturn ? '\n' : buffer[k];
+	}
+	return w;
+}
+
+/* PUBLIC FUNCTIONS */
+
+boolean setSourceInputEncoding(const char * name) {
+	if (strcmp(name, "auto") == 0) {
+		_isDetected = true;
+		return true;
+	}
+	_isDetected = false;
+	return findInputEncoding(name, &_encoding);
+}
+
+int readSourceInput(FILE * source, char * buffer, const int size) {
+	if (_isInvalid || size < UTF8_MAXIMUM_LENGTH) {
+		return 0;
+	}
+	if (!_isStarted) {
+		_start(source);
+	}
+	while (true) {
+		if (!_isEnd && _rawEnd - _rawStart < SOURCE_INPUT_CHUNK / 2) {
+			_fill(source);
+		}
+		size_t consumed = 0;
+		size_t written = 0;
+		const TranscodingStatus status = transcodeInput(&_encoding, _raw + _rawStart, _rawEnd - _rawStart, _isEnd, buffer, size, &consumed, &written);
+		_rawStart += consumed;
+		_offset += consumed;
+		if (status == TRANSCODING_TRUNCATED) {
+			logError(_logger, "Truncated %s sequence at the end of the input (byte offset %zu).", getInputEncodingName(&_encoding), _offset);
+			_isInvalid = true;
+		}
+		else if (status == TRANSCODING_INVALID) {
+			logError(_logger, "Invalid %s sequence at byte offset %zu of the input.", getInputEncodingName(&_encoding), _offset);
+			_isInvalid = true;
+		}
+		const size_t length = _normalizeNewlines(buffer, written);
+		if (length != 0 || _isInvalid || (_isEnd && _rawStart == _rawEnd)) {
+			return (int) length;
+		}
+	}
+}
+
+boolean isSourceInputValid() {
+	return !_isInvalid;
+}
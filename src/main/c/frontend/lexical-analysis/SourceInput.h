@@ -0,0 +1,41 @@
+#ifndef SOURCE_INPUT_HEADER
+#define SOURCE_INPUT_HEADER
+
+#include "../../shared/Logger.h"
+#include "../../shared/Utf8.h"
+#include "../../shared/Type.h"
+#include "InputEncoding.h"
+#include <stdio.h>
+#include <string.h>
+
+/** The number of bytes of the source that are read (and detected) at once. */
+#define SOURCE_INPUT_CHUNK 65536
+
+/** Initialize module's internal state. */
+void initializeSourceInputModule();
+
+/** Shutdown module's internal state. */
+void shutdownSourceInputModule();
+
+/**
+ * Sets the encoding of the source (see "findInputEncoding"), or "auto" to
+ * detect it from the first chunk (see "detectInputEncoding"), which is the
+ * default. Returns false if the encoding is unknown.
+ */
+boolean setSourceInputEncoding(const char * name);
+
+/**
+ * Reads the next chunk of the source for Flex (see "YY_INPUT"), of at most
+ * "size" bytes, transcoded into UTF-8. A byte order mark at the start is
+ * dropped (and it tells the encoding, unless it's a legacy one), and every
+ * CRLF or lone CR becomes a LF. Only well-formed UTF-8 is ever returned: a
+ * character split between two reads is kept for the next one, and the first
+ * invalid one is reported (with its byte offset in the source) and ends the
+ * input. Returns zero at the end of the input.
+ */
+int readSourceInput(FILE * source, char * buffer, const int size);
+
+/** Returns true if all the source read so far was well-formed in its encoding. */
+boolean isSourceInputValid();
+
+#endif
@@ -1,5 +1,6 @@
 #include "SyntacticAnalyzer.h"
 #include "../lexical-analysis/LexicalAnalyzerContext.h"
+#include "../lexical-analysis/SourceInput.h"
 
 /* MODULE INTERNAL STATE */
 
@@ -53,6 +54,10 @@ SyntacticAnalysisStatus parse(CompilerState * compilerState) {
 	_currentCompilerState = NULL;
 	SyntacticAnalysisStatus syntacticAnalysisStatus;
 	logDebugging(_logger, "Parsing is done.");
+	if (!isSourceInputValid()) {
+		compilerState->succeed = false;
+		return REJECT;
+	}
 	switch (code) {
 		case 0:
 			if (compilerState->succeed == true) {
@@ -3,6 +3,8 @@
 
 #include "Type.h"
 
+struct BlockCache;
+
 /**
  * The general status of a compilation.
 */
@@ -23,6 +25,9 @@ typedef struct {
 	// A flag that indicates the current state of the compilation so far.
 	boolean succeed;
 
+	// The incremental cache of top-level blocks (only with an output directory).
+	struct BlockCache * blockCache;
+
 	// TODO: Add an stack to handle nested scopes.
 	// TODO: Add symbols stack.
 	// TODO: Add configuration.
@@ -0,0 +1,31 @@
+#include "Hash.h"
+
+/* MODULE INTERNAL STATE */
+
+static const Hash _prime = 0x00000100000001B3ULL;
+
+/* PUBLIC FUNCTIONS */
+
+Hash hashBytes(Hash hash, const void * bytes, const size_t length) {
+	const unsigned char * data = bytes;
+	for (size_t k = 0; k < length; ++k) {
+		hash ^= data[k];
+		hash *= _prime;
+	}
+	return hash;
+}
+
+Hash hashString(Hash hash, const char * string) {
+	if (string != NULL) {
+		for (; *string != '\0'; ++string) {
+			hash ^= (unsigned char) *string;
+			hash *= _prime;
+		}
+	}
+	hash *= _prime;
+	return hash;
+}
+
+Hash hashInteger(Hash hash, const int64_t value) {
+	return hashBytes(hash, &value, sizeof(value));
+}
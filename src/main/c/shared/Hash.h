@@ -0,0 +1,35 @@
+#ifndef HASH_HEADER
+#define HASH_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A 64-bit non-cryptographic content hash (FNV-1a). It's only used to detect
+ * changes between compilations, never for security.
+ *
+ * @see http://www.isthe.com/chongo/tech/comp/fnv/
+ */
+typedef uint64_t Hash;
+
+/** The initial value of every hash. */
+#define HASH_SEED ((Hash) 0xCBF29CE484222325ULL)
+
+/**
+ * Feeds a sequence of bytes into a running hash, and returns the new value.
+ */
+Hash hashBytes(Hash hash, const void * bytes, const size_t length);
+
+/**
+ * Feeds a string into a running hash, including its terminator, so that
+ * consecutive strings cannot collide by moving characters between them. A
+ * NULL string is hashed as if it were empty.
+ */
+Hash hashString(Hash hash, const char * string);
+
+/**
+ * Feeds an integer into a running hash.
+ */
+Hash hashInteger(Hash hash, const int64_t value);
+
+#endif
@@ -1,26 +1,71 @@
 #include "Logger.h"
 
+/* MODULE INTERNAL STATE */
+
+// Every thread keeps its own builder of messages, to log without allocating.
+// It's released when the thread exits (or at exit, for the main one).
+static pthread_once_t _scratchOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t _scratchKey;
+
 /* PRIVATE FUNCTIONS */
 
+static void _createScratchKey();
+static StringBuilder * _getScratch();
+static void _releaseScratch(void * scratch);
+static void _releaseThreadScratch();
 static void _log(const Logger * logger, const LoggingLevel loggingLevel, const char * const format, va_list arguments);
 static LoggingLevel _loggingLevelFromString(const char * loggingLevel);
 static void _logInStream(FILE * const stream, const char * const format, va_list arguments);
 static const char * _toContextString(const LoggingLevel loggingLevel);
 
+static void _createScratchKey() {
+	pthread_key_create(&_scratchKey, _releaseScratch);
+	atexit(_releaseThreadScratch);
+}
+
+static StringBuilder * _getScratch() {
+	pthread_once(&_scratchOnce, _createScratchKey);
+	StringBuilder * scratch = pthread_getspecific(_scratchKey);
+	if (scratch == NULL) {
+		scratch = calloc(1, sizeof(StringBuilder));
+		pthread_setspecific(_scratchKey, scratch);
+	}
+	return scratch;
+}
+
+static void _releaseScratch(void * scratch) {
+	releaseStringBuilder(scratch);
+	free(scratch);
+}
+
+// The destructors of the keys don't run for the thread that calls "exit".
+static void _releaseThreadScratch() {
+	StringBuilder * scratch = pthread_getspecific(_scratchKey);
+	if (scratch != NULL) {
+		pthread_setspecific(_scratchKey, NULL);
+		_releaseScratch(scratch);
+	}
+}
+
 /**
  * Logs a new message at the specified level, using a format string.
  */
 static void _log(const Logger * logger, const LoggingLevel loggingLevel, const char * const format, va_list arguments) {
 	if (logger->loggingLevel <= loggingLevel) {
-		const char * context = _toContextString(loggingLevel);
-		char * effectiveFormat = concatenate(6, context, "[", logger->name, "] ", format, "\n");
+		StringBuilder * effectiveFormat = _getScratch();
+		clearStringBuilder(effectiveFormat);
+		appendString(effectiveFormat, _toContextString(loggingLevel));
+		appendCharacter(effectiveFormat, '[');
+		appendString(effectiveFormat, logger->name);
+		appendString(effectiveFormat, "] ");
+		appendString(effectiveFormat, format);
+		appendCharacter(effectiveFormat, '\n');
 		if (ERROR <= loggingLevel) {
-			_logInStream(stderr, effectiveFormat, arguments);
+			_logInStream(stderr, peekStringBuilder(effectiveFormat), arguments);
 		}
 		else {
-			_logInStream(stdout, effectiveFormat, arguments);
+			_logInStream(stdout, peekStringBuilder(effectiveFormat), arguments);
 		}
-		free(effectiveFormat);
 	}
 }
 
@@ -3,6 +3,7 @@
 
 #include "Environment.h"
 #include "String.h"
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -1,8 +1,14 @@
 #include "String.h"
 
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
 /* PRIVATE FUNCTIONS */
 
 static const char * _controlCharacterToEscapedString(const char character);
+static const char * _latexSpecialToEscapedString(const char character);
+static size_t _nextLatexSpecial(const char * string, size_t from, const size_t length);
 
 /**
  * Returns a read-only string that represents the escaped sequence of the
@@ -48,49 +54,90 @@ static const char * _controlCharacterToEscapedString(const char character) {
 	}
 }
 
+/**
+ * Returns a read-only string with the LaTeX code that typesets the special
+ * character. If the character is not special, then returns NULL.
+ */
+static const char * _latexSpecialToEscapedString(const char character) {
+	switch (character) {
+		case '\\': return "\\textbackslash{}";
+		case '{': return "\\{";
+		case '}': return "\\}";
+		case '$': return "\\$";
+		case '&': return "\\&";
+		case '#': return "\\#";
+		case '^': return "\\textasciicircum{}";
+		case '_': return "\\_";
+		case '~': return "\\textasciitilde{}";
+		case '%': return "\\%";
+		default:
+			return NULL;
+	}
+}
+
+/**
+ * Returns the index of the next LaTeX special character of the string,
+ * starting from the specified one, or its length if there's none. With SSE2,
+ * 16 characters are compared against the whole set at once, so clean text is
+ * skipped quickly.
+ */
+static size_t _nextLatexSpecial(const char * string, size_t from, const size_t length) {
+#if defined(__SSE2__)
+	static const char specials[] = "\\{}$&#^_~%";
+	while (from + 16 <= length) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *) (string + from));
+		__m128i matches = _mm_setzero_si128();
+		for (unsigned int k = 0; k < sizeof(specials) - 1; ++k) {
+			matches = _mm_or_si128(matches, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(specials[k])));
+		}
+		const int mask = _mm_movemask_epi8(matches);
+		if (mask != 0) {
+			return from + __builtin_ctz(mask);
+		}
+		from += 16;
+	}
+#endif
+	while (from < length && _latexSpecialToEscapedString(string[from]) == NULL) {
+		++from;
+	}
+	return from;
+}
+
 /* PUBLIC FUNCTIONS */
 
 char * concatenate(const unsigned int count, ...) {
 	va_list arguments;
 	va_start(arguments, count);
-	unsigned int length = 1;
+	size_t length = 0;
 	for (unsigned int k = 0; k < count; ++k) {
 		const char * nextString = va_arg(arguments, const char *);
 		length += strlen(nextString);
 	}
 	va_end(arguments);
-	char * string = calloc(length, sizeof(char));
+	StringBuilder builder = {0};
+	reserveStringBuilder(&builder, length);
 	va_start(arguments, count);
 	for (unsigned int k = 0; k < count; ++k) {
 		const char * nextString = va_arg(arguments, const char *);
-		strcat(string, nextString);
+		appendString(&builder, nextString);
 	}
 	va_end(arguments);
-	return string;
+	return buildString(&builder);
 }
 
 char * escape(const char * string) {
-	unsigned int length = 1;
-	for (unsigned int k = 0; 0 < string[k]; ++k) {
-		if (iscntrl(string[k])) {
-			length += strlen(_controlCharacterToEscapedString(string[k]));
-		}
-		else {
-			length += 1;
-		}
-	}
-	char * escapedString = calloc(length, sizeof(char));
-	char charToString[2] = { 0, 0 };
-	for (unsigned int k = 0; 0 < string[k]; ++k) {
-		if (iscntrl(string[k])) {
-			strcat(escapedString, _controlCharacterToEscapedString(string[k]));
-		}
-		else {
-			charToString[0] = string[k];
-			strcat(escapedString, charToString);
+	StringBuilder builder = {0};
+	const char * start = string;
+	const char * character = string;
+	for (; 0 < *character; ++character) {
+		if (iscntrl(*character)) {
+			appendStringWithLength(&builder, start, character - start);
+			appendString(&builder, _controlCharacterToEscapedString(*character));
+			start = character + 1;
 		}
 	}
-	return escapedString;
+	appendStringWithLength(&builder, start, character - start);
+	return buildString(&builder);
 }
 
 char * indentation(const char character, const unsigned int level, const unsigned int size) {
@@ -101,3 +148,19 @@ char * indentation(const char character, const unsigned int level, const unsigne
 	}
 	return indentation;
 }
+
+char * escapeLatex(const char * string) {
+	const size_t length = strlen(string);
+	StringBuilder builder = {0};
+	reserveStringBuilder(&builder, length);
+	size_t start = 0;
+	for (size_t k = _nextLatexSpecial(string, 0, length); start < length; k = _nextLatexSpecial(string, k + 1, length)) {
+		// Clean runs are copied in bulk.
+		appendStringWithLength(&builder, string + start, k - start);
+		if (k < length) {
+			appendString(&builder, _latexSpecialToEscapedString(string[k]));
+		}
+		start = k + 1;
+	}
+	return buildString(&builder);
+}
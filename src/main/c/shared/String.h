@@ -5,6 +5,7 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
+#include "StringBuilder.h"
 
 /**
  * Concatenates a list of strings. The returned string must be freed because
@@ -22,6 +23,15 @@ char * concatenate(const unsigned int count, ...);
  */
 char * escape(const char * string);
 
+/**
+ * Creates a new string (using heap-memory), that is equal to the original,
+ * but with every LaTeX special character (i.e., "\\", "{", "}", "$", "&",
+ * "#", "^", "_", "~" and "%") escaped, so the text is typeset verbatim. Only
+ * text that is not LaTeX source (e.g., romanizations and parameters) must be
+ * escaped.
+ */
+char * escapeLatex(const char * string);
+
 /**
  * Generates an indentation string for the specified level, using heap-memory.
  *
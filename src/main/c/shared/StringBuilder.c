@@ -0,0 +1,90 @@
+#include "StringBuilder.h"
+
+/* MODULE INTERNAL STATE */
+
+static const size_t _minimumCapacity = 64;
+
+/* PUBLIC FUNCTIONS */
+
+void reserveStringBuilder(StringBuilder * builder, const size_t additional) {
+	const size_t required = builder->length + additional + 1;
+	if (required <= builder->capacity) {
+		return;
+	}
+	size_t capacity = builder->capacity < _minimumCapacity ? _minimumCapacity : builder->capacity;
+	while (capacity < required) {
+		capacity *= 2;
+	}
+	char * data = realloc(builder->data, capacity);
+	if (data == NULL) {
+		abort();
+	}
+	data[builder->length] = '\0';
+	builder->data = data;
+	builder->capacity = capacity;
+}
+
+void appendString(StringBuilder * builder, const char * string) {
+	appendStringWithLength(builder, string, strlen(string));
+}
+
+void appendStringWithLength(StringBuilder * builder, const char * string, const size_t length) {
+	reserveStringBuilder(builder, length);
+	memcpy(builder->data + builder->length, string, length);
+	builder->length += length;
+	builder->data[builder->length] = '\0';
+}
+
+void appendCharacter(StringBuilder * builder, const char character) {
+	reserveStringBuilder(builder, 1);
+	builder->data[builder->length++] = character;
+	builder->data[builder->length] = '\0';
+}
+
+void appendFormat(StringBuilder * builder, const char * const format, ...) {
+	va_list arguments;
+	va_start(arguments, format);
+	appendFormatList(builder, format, arguments);
+	va_end(arguments);
+}
+
+void appendFormatList(StringBuilder * builder, const char * const format, va_list arguments) {
+	va_list copy;
+	va_copy(copy, arguments);
+	const int length = vsnprintf(NULL, 0, format, copy);
+	va_end(copy);
+	if (length < 0) {
+		return;
+	}
+	reserveStringBuilder(builder, length);
+	vsnprintf(builder->data + builder->length, length + 1, format, arguments);
+	builder->length += length;
+}
+
+const char * peekStringBuilder(StringBuilder * builder) {
+	reserveStringBuilder(builder, 0);
+	return builder->data;
+}
+
+void clearStringBuilder(StringBuilder * builder) {
+	builder->length = 0;
+	if (builder->data != NULL) {
+		builder->data[0] = '\0';
+	}
+}
+
+char * buildString(StringBuilder * builder) {
+	reserveStringBuilder(builder, 0);
+	char * string = builder->data;
+	builder->data = NULL;
+	builder->length = 0;
+	builder->capacity = 0;
+	return string;
+}
+
+void releaseStringBuilder(StringBuilder * builder) {
+	free(builder->data);
+	builder->data = NULL;
+	builder->length = 0;
+	builder->capacity = 0;
+}
@@ -0,0 +1,59 @@
+#ifndef STRING_BUILDER_HEADER
+#define STRING_BUILDER_HEADER
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * A growable string, with amortized constant-time appends. A zeroed builder
+ * is a valid empty one, so it can live in the stack, or be kept (e.g., in a
+ * static variable) and cleared to reuse its memory across calls.
+ */
+typedef struct {
+	char * data;
+	size_t length;
+	size_t capacity;
+} StringBuilder;
+
+/**
+ * Ensures that the builder can hold the specified number of additional
+ * characters without growing again.
+ */
+void reserveStringBuilder(StringBuilder * builder, const size_t additional);
+
+/** Appends a null-terminated string. */
+void appendString(StringBuilder * builder, const char * string);
+
+/** Appends the first "length" characters of the string. */
+void appendStringWithLength(StringBuilder * builder, const char * string, const size_t length);
+
+/** Appends a single character. */
+void appendCharacter(StringBuilder * builder, const char character);
+
+/** Appends a formatted string, as "printf" does. */
+void appendFormat(StringBuilder * builder, const char * const format, ...);
+
+/** Appends a formatted string, as "vprintf" does. */
+void appendFormatList(StringBuilder * builder, const char * const format, va_list arguments);
+
+/**
+ * Returns the content of the builder as a read-only string, that is only
+ * valid until the next change.
+ */
+const char * peekStringBuilder(StringBuilder * builder);
+
+/** Empties the builder, but keeps its memory to be reused. */
+void clearStringBuilder(StringBuilder * builder);
+
+/**
+ * Returns the content of the builder as a new string (the builder's memory,
+ * without copying it), that must be freed. The builder is left empty.
+ */
+char * buildString(StringBuilder * builder);
+
+/** Releases the memory of the builder, which is left empty. */
+void releaseStringBuilder(StringBuilder * builder);
+
+#endif
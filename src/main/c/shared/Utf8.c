@@ -0,0 +1,179 @@
+#include "Utf8.h"
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+/* PRIVATE FUNCTIONS */
+
+static size_t _asciiLength(const unsigned char * bytes, const size_t length);
+static size_t _decodeSequence(const unsigned char * bytes, const size_t length, uint32_t * codepoint, boolean * isTruncated);
+
+/**
+ * Returns the length of the ASCII run at the start of the bytes. With SSE2,
+ * the high bits of 16 bytes are tested at once.
+ */
+static size_t _asciiLength(const unsigned char * bytes, const size_t length) {
+	size_t k = 0;
+#if defined(__SSE2__)
+	while (k + 16 <= length) {
+		const int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) (bytes + k)));
+		if (mask != 0) {
+			return k + __builtin_ctz(mask);
+		}
+		k += 16;
+	}
+#endif
+	while (k < length && bytes[k] < 0x80) {
+		++k;
+	}
+	return k;
+}
+
+/**
+ * Decodes the sequence at the start of the bytes, and returns its length, or
+ * zero if it's not well-formed. In that case, "isTruncated" tells whether the
+ * sequence was only cut short by the end of the bytes. The second byte has a
+ * narrower range after some leading bytes, that rules out overlong encodings,
+ * surrogates and codepoints above U+10FFFF.
+ */
+static size_t _decodeSequence(const unsigned char * bytes, const size_t length, uint32_t * codepoint, boolean * isTruncated) {
+	const unsigned char lead = bytes[0];
+	unsigned char lower = 0x80;
+	unsigned char upper = 0xBF;
+	size_t size = 0;
+	uint32_t value = 0;
+	*isTruncated = false;
+	if (lead < 0x80) {
+		*codepoint = lead;
+		return 1;
+	}
+	else if (0xC2 <= lead && lead <= 0xDF) {
+		size = 2;
+		value = lead & 0x1F;
+	}
+	else if (0xE0 <= lead && lead <= 0xEF) {
+		size = 3;
+		value = lead & 0x0F;
+		lower = lead == 0xE0 ? 0xA0 : lower;
+		upper = lead == 0xED ? 0x9F : upper;
+	}
+	else if (0xF0 <= lead && lead <= 0xF4) {
+		size = 4;
+		value = lead & 0x07;
+		lower = lead == 0xF0 ? 0x90 : lower;
+		upper = lead == 0xF4 ? 0x8F : upper;
+	}
+	else {
+		return 0;
+	}
+	for (size_t k = 1; k < size; ++k) {
+		if (length <= k) {
+			*isTruncated = true;
+			return 0;
+		}
+		const unsigned char minimum = k == 1 ? lower : 0x80;
+		const unsigned char maximum = k == 1 ? upper : 0xBF;
+		if (bytes[k] < minimum || maximum < bytes[k]) {
+			return 0;
+		}
+		value = (value << 6) | (bytes[k] & 0x3F);
+	}
+	*codepoint = value;
+	return size;
+}
+
+/* PUBLIC FUNCTIONS */
+
+size_t validUtf8Length(const char * bytes, const size_t length) {
+	const unsigned char * data = (const unsigned char *) bytes;
+	size_t k = 0;
+	while (k < length) {
+		k += _asciiLength(data + k, length - k);
+		if (k == length) {
+			break;
+		}
+		uint32_t codepoint;
+		boolean isTruncated;
+		const size_t size = _decodeSequence(data + k, length - k, &codepoint, &isTruncated);
+		if (size == 0) {
+			break;
+		}
+		k += size;
+	}
+	return k;
+}
+
+boolean isTruncatedUtf8(const char * bytes, const size_t length) {
+	uint32_t codepoint;
+	boolean isTruncated = false;
+	return 0 < length && _decodeSequence((const unsigned char *) bytes, length, &codepoint, &isTruncated) == 0 && isTruncated;
+}
+
+size_t decodeUtf8(const char * bytes, const size_t length, uint32_t * codepoints, const size_t capacity, size_t * consumed) {
+	const unsigned char * data = (const unsigned char *) bytes;
+	size_t k = 0;
+	size_t count = 0;
+	while (k < length && count < capacity) {
+#if defined(__SSE2__)
+		// Widens 16 ASCII bytes to 16 codepoints.
+		const __m128i zero = _mm_setzero_si128();
+		while (k + 16 <= length && count + 16 <= capacity) {
+			const __m128i chunk = _mm_loadu_si128((const __m128i *) (data + k));
+			if (_mm_movemask_epi8(chunk) != 0) {
+				break;
+			}
+			const __m128i low = _mm_unpacklo_epi8(chunk, zero);
+			const __m128i high = _mm_unpackhi_epi8(chunk, zero);
+			_mm_storeu_si128((__m128i *) (codepoints + count), _mm_unpacklo_epi16(low, zero));
+			_mm_storeu_si128((__m128i *) (codepoints + count + 4), _mm_unpackhi_epi16(low, zero));
+			_mm_storeu_si128((__m128i *) (codepoints + count + 8), _mm_unpacklo_epi16(high, zero));
+			_mm_storeu_si128((__m128i *) (codepoints + count + 12), _mm_unpackhi_epi16(high, zero));
+			k += 16;
+			count += 16;
+		}
+		if (length <= k || capacity <= count) {
+			break;
+		}
+#endif
+		if (data[k] < 0x80) {
+			codepoints[count++] = data[k++];
+			continue;
+		}
+		boolean isTruncated;
+		const size_t size = _decodeSequence(data + k, length - k, &codepoints[count], &isTruncated);
+		if (size == 0) {
+			codepoints[count] = REPLACEMENT_CHARACTER;
+			k += 1;
+		}
+		else {
+			k += size;
+		}
+		++count;
+	}
+	*consumed = k;
+	return count;
+}
+
+size_t encodeUtf8(const uint32_t codepoint, char * bytes) {
+	if (codepoint < 0x80) {
+		bytes[0] = (char) codepoint;
+		return 1;
+	}
+	if (codepoint < 0x800) {
+		bytes[0] = (char) (0xC0 | codepoint >> 6);
+		bytes[1] = (char) (0x80 | (codepoint & 0x3F));
+		return 2;
+	}
+	if (codepoint < 0x10000) {
+		bytes[0] = (char) (0xE0 | codepoint >> 12);
+		bytes[1] = (char) (0x80 | (codepoint >> 6 & 0x3F));
+		bytes[2] = (char) (0x80 | (codepoint & 0x3F));
+		return 3;
+	}
+	bytes[0] = (char) (0xF0 | codepoint >> 18);
+	bytes[1] = (char) (0x80 | (codepoint >> 12 & 0x3F));
+	bytes[2] = (char) (0x80 | (codepoint >> 6 & 0x3F));
+	bytes[3] = (char) (0x80 | (codepoint & 0x3F));
+	return 4;
+}
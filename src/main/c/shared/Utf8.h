@@ -0,0 +1,42 @@
+#ifndef UTF8_HEADER
+#define UTF8_HEADER
+
+#include "Type.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** The codepoint that replaces every invalid sequence while decoding. */
+#define REPLACEMENT_CHARACTER ((uint32_t) 0xFFFD)
+
+/**
+ * Returns the length of the longest well-formed UTF-8 prefix of the bytes.
+ * If it's shorter than the bytes, that offset is where the first invalid (or
+ * truncated) sequence starts. Overlong encodings, surrogates and codepoints
+ * above U+10FFFF are invalid. ASCII runs are skipped 16 bytes at a time.
+ */
+size_t validUtf8Length(const char * bytes, const size_t length);
+
+/**
+ * Returns true if the bytes are the beginning of a well-formed sequence that
+ * was cut short, so more input could complete it.
+ */
+boolean isTruncatedUtf8(const char * bytes, const size_t length);
+
+/**
+ * Decodes the bytes into at most "capacity" codepoints, and returns how many
+ * were decoded. The number of bytes consumed is stored in "consumed", and it
+ * never splits a sequence, so the rest can be decoded by a later call. ASCII
+ * runs are widened without decoding. Every invalid byte is decoded as the
+ * REPLACEMENT_CHARACTER, and a truncated sequence at the end is never read
+ * past the length.
+ */
+size_t decodeUtf8(const char * bytes, const size_t length, uint32_t * codepoints, const size_t capacity, size_t * consumed);
+
+/**
+ * Encodes the (valid) codepoint into at most 4 bytes, and returns how many
+ * were written.
+ */
+size_t encodeUtf8(const uint32_t codepoint, char * bytes);
+
+#endif
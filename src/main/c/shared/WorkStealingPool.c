@@ -0,0 +1,136 @@
+#include "WorkStealingPool.h"
+
+/* PRIVATE TYPES */
+
+/**
+ * The pending tasks of a worker, as a range of indices [front, back).
+ */
+typedef struct {
+	pthread_mutex_t mutex;
+	size_t front;
+	size_t back;
+} TaskDeque;
+
+typedef struct {
+	TaskDeque * deques;
+	unsigned int workers;
+	ParallelTask task;
+	void * data;
+} Pool;
+
+typedef struct {
+	Pool * pool;
+	unsigned int id;
+} Worker;
+
+/* PRIVATE FUNCTIONS */
+
+static int _take(TaskDeque * deque, size_t * index);
+static int _steal(Pool * pool, const unsigned int thief);
+static void * _work(void * argument);
+
+/**
+ * Takes the next task of the front of a deque. Returns false if it's empty.
+ */
+static int _take(TaskDeque * deque, size_t * index) {
+	pthread_mutex_lock(&deque->mutex);
+	const int taken = deque->front < deque->back;
+	if (taken) {
+		*index = deque->front++;
+	}
+	pthread_mutex_unlock(&deque->mutex);
+	return taken;
+}
+
+/**
+ * Moves the back half of the range of some other worker into the (empty)
+ * deque of the thief. Only a lock is held at any time, so there is no lock
+ * ordering to respect. Returns false if there was nothing left to steal: since
+ * tasks never create more tasks, the thief can then finish.
+ */
+static int _steal(Pool * pool, const unsigned int thief) {
+	for (unsigned int k = 1; k < pool->workers; ++k) {
+		TaskDeque * victim = &pool->deques[(thief + k) % pool->workers];
+		pthread_mutex_lock(&victim->mutex);
+		const size_t front = victim->front;
+		const size_t back = victim->back;
+		const size_t middle = front + (back - front) / 2;
+		if (front < back) {
+			victim->back = middle;
+		}
+		pthread_mutex_unlock(&victim->mutex);
+		if (front < back) {
+			TaskDeque * own = &pool->deques[thief];
+			pthread_mutex_lock(&own->mutex);
+			own->front = middle;
+			own->back = back;
+			pthread_mutex_unlock(&own->mutex);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void * _work(void * argument) {
+	Worker * worker = argument;
+	Pool * pool = worker->pool;
+	size_t index = 0;
+	do {
+		while (_take(&pool->deques[worker->id], &index)) {
+			pool->task(pool->data, index);
+		}
+	} while (_steal(pool, worker->id));
+	return NULL;
+}
+
+/* PUBLIC FUNCTIONS */
+
+void runParallelTasks(const unsigned int workers, const size_t count, ParallelTask task, void * data) {
+	if (workers <= 1 || count <= 1) {
+		for (size_t index = 0; index < count; ++index) {
+			task(data, index);
+		}
+		return;
+	}
+	const unsigned int size = count < workers ? (unsigned int) count : workers;
+	Pool pool = {
+		.deques = calloc(size, sizeof(TaskDeque)),
+		.workers = size,
+		.task = task,
+		.data = data
+	};
+	Worker * team = calloc(size, sizeof(Worker));
+	pthread_t * threads = calloc(size, sizeof(pthread_t));
+
+	// Every worker starts with a contiguous slice of the tasks.
+	for (unsigned int k = 0; k < size; ++k) {
+		pthread_mutex_init(&pool.deques[k].mutex, NULL);
+		pool.deques[k].front = count * k / size;
+		pool.deques[k].back = count * (k + 1) / size;
+		team[k] = (Worker) { .pool = &pool, .id = k };
+	}
+	unsigned int started = 1;
+	for (; started < size; ++started) {
+		if (pthread_create(&threads[started], NULL, &_work, &team[started]) != 0) {
+			break;
+		}
+	}
+	// If some thread could not start, its slice will be stolen by the others.
+	_work(&team[0]);
+	for (unsigned int k = 1; k < started; ++k) {
+		pthread_join(threads[k], NULL);
+	}
+	// A worker that never started may still hold tasks.
+	for (unsigned int k = started; k < size; ++k) {
+		size_t index = 0;
+		while (_take(&pool.deques[k], &index)) {
+			task(data, index);
+		}
+	}
+	for (unsigned int k = 0; k < size; ++k) {
+		pthread_mutex_destroy(&pool.deques[k].mutex);
+	}
+	free(threads);
+	free(team);
+	free(pool.deques);
+}
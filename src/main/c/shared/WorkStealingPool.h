@@ -0,0 +1,23 @@
+#ifndef WORK_STEALING_POOL_HEADER
+#define WORK_STEALING_POOL_HEADER
+
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * A task of a parallel loop. It receives the shared data of the loop, and the
+ * index of the task to run.
+ */
+typedef void (*ParallelTask)(void * data, const size_t index);
+
+/**
+ * Runs every task index in the range [0, count) over the specified number of
+ * workers, and waits for all of them. Each worker owns a deque with a range of
+ * pending indices: it takes tasks from the front of its own range, and once it
+ * runs dry, it steals the back half of the range of another worker. The
+ * calling thread is also a worker, so with a single worker (or a single task)
+ * everything runs in place, in order.
+ */
+void runParallelTasks(const unsigned int workers, const size_t count, ParallelTask task, void * data);
+
+#endif
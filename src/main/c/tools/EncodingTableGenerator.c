@@ -0,0 +1,224 @@
+/**
+ * Generates the tables of the legacy encodings of the input (see
+ * "EncodingTables.h") at build time, from the mappings of a directory. The
+ * encodings are listed in the "encodings.tsv" file of the directory, a line
+ * per encoding as:
+ *
+ *	name<tab>mapping<tab>first letter<tab>last letter
+ *
+ * where the mapping is a file of the directory, and the letters are codepoints
+ * (as "U+0400"). Every line of a mapping is as:
+ *
+ *	0xXX[XX]<tab>0xUUUU[<tab># comment]
+ *
+ * where the bytes (a single one, or a pair) are decoded as the codepoint.
+ * Lines that start with "#" are comments, and the bytes that aren't listed are
+ * undefined. Every encoding must map ASCII to itself. The pairs are written as
+ * a dense table, from the first lead and trail to the last ones.
+ *
+ * Usage: EncodingTableGenerator <output.c> <data directory>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MANIFEST_FILE_NAME "encodings.tsv"
+#define PAIR_COUNT 65536
+
+typedef struct {
+	char * name;
+	char * fileName;
+	uint32_t firstLetter;
+	uint32_t lastLetter;
+	uint16_t singles[256];
+	// Indexed by the pair (lead and trail) itself, while it's loaded.
+	uint16_t * pairs;
+	unsigned int firstLead;
+	unsigned int lastLead;
+	unsigned int firstTrail;
+	unsigned int lastTrail;
+} Encoding;
+
+static void _fail(const char * message, const char * argument) {
+	fprintf(stderr, "EncodingTableGenerator: %s%s\n", message, argument);
+	exit(EXIT_FAILURE);
+}
+
+static uint32_t _parseCodepoint(const char * text, const char * line) {
+	char * end = NULL;
+	if (strncmp(text, "U+", 2) != 0) {
+		_fail("malformed codepoint in line: ", line);
+	}
+	const unsigned long codepoint = strtoul(text + 2, &end, 16);
+	if (*end != '\0' || 0x10FFFF < codepoint) {
+		_fail("malformed codepoint in line: ", line);
+	}
+	return (uint32_t) codepoint;
+}
+
+/**
+ * Loads the mapping of the encoding. A mapping with pairs gets the bounds of
+ * their leads and trails.
+ */
+static void _loadMapping(Encoding * encoding, const char * directory) {
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/%s", directory, encoding->fileName);
+	FILE * file = fopen(path, "r");
+	if (file == NULL) {
+		_fail("cannot open ", path);
+	}
+	encoding->firstLead = encoding->firstTrail = 0xFF;
+	char line[1024];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0' || line[0] == '#') {
+			continue;
+		}
+		char * end = NULL;
+		const unsigned long bytes = strtoul(line, &end, 16);
+		const size_t digits = end - line - 2;
+		if (strncmp(line, "0x", 2) != 0 || *end != '\t' || (digits != 2 && digits != 4)) {
+			_fail("malformed bytes in line: ", line);
+		}
+		const unsigned long codepoint = strtoul(end + 1, &end, 16);
+		if ((*end != '\0' && *end != '\t') || 0xFFFF < codepoint || (codepoint == 0 && bytes != 0)) {
+			_fail("malformed (or unsupported) codepoint in line: ", line);
+		}
+		if (digits == 2) {
+			encoding->singles[bytes] = (uint16_t) codepoint;
+			continue;
+		}
+		const unsigned int lead = bytes >> 8;
+		const unsigned int trail = bytes & 0xFF;
+		if (lead < 0x80) {
+			_fail("a pair can't lead with ASCII, in line: ", line);
+		}
+		if (encoding->pairs == NULL) {
+			encoding->pairs = calloc(PAIR_COUNT, sizeof(uint16_t));
+		}
+		encoding->pairs[bytes] = (uint16_t) codepoint;
+		encoding->firstLead = lead < encoding->firstLead ? lead : encoding->firstLead;
+		encoding->lastLead = encoding->lastLead < lead ? lead : encoding->lastLead;
+		encoding->firstTrail = trail < encoding->firstTrail ? trail : encoding->firstTrail;
+		encoding->lastTrail = encoding->lastTrail < trail ? trail : encoding->lastTrail;
+	}
+	fclose(file);
+	for (unsigned int byte = 1; byte < 0x80; ++byte) {
+		if (encoding->singles[byte] != byte) {
+			_fail("the encoding must be ASCII-compatible, in ", path);
+		}
+	}
+	if (encoding->pairs == NULL) {
+		encoding->firstLead = encoding->firstTrail = 0;
+		return;
+	}
+	for (unsigned int lead = encoding->firstLead; lead <= encoding->lastLead; ++lead) {
+		if (encoding->singles[lead] != 0) {
+			_fail("a byte is both single and the lead of a pair, in ", path);
+		}
+	}
+}
+
+static void _writeEncoding(FILE * output, const Encoding * encoding, size_t index) {
+	fprintf(output, "// %s\n", encoding->name);
+	fprintf(output, "static const uint16_t _encoding%zuSingles[] = {", index);
+	for (size_t k = 0; k < 256; ++k) {
+		fprintf(output, "%s0x%04X,", k % 8 == 0 ? "\n\t" : " ", encoding->singles[k]);
+	}
+	fprintf(output, "\n};\n\n");
+	if (encoding->pairs == NULL) {
+		return;
+	}
+	fprintf(output, "static const uint16_t _encoding%zuPairs[] = {", index);
+	size_t count = 0;
+	for (unsigned int lead = encoding->firstLead; lead <= encoding->lastLead; ++lead) {
+		for (unsigned int trail = encoding->firstTrail; trail <= encoding->lastTrail; ++trail) {
+			fprintf(output, "%s0x%04X,", count++ % 8 == 0 ? "\n\t" : " ", encoding->pairs[lead << 8 | trail]);
+		}
+	}
+	fprintf(output, "\n};\n\n");
+}
+
+/**
+ * Loads the encodings of the manifest, and returns how many there are.
+ */
+static size_t _loadManifest(const char * directory, Encoding ** encodings) {
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/%s", directory, MANIFEST_FILE_NAME);
+	FILE * file = fopen(path, "r");
+	if (file == NULL) {
+		_fail("cannot open ", path);
+	}
+	size_t count = 0;
+	char line[1024];
+	char copy[1024];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0' || line[0] == '#') {
+			continue;
+		}
+		strcpy(copy, line);
+		char * fields[4] = {NULL};
+		size_t fieldCount = 0;
+		for (char * field = strtok(copy, "\t"); field != NULL && fieldCount < 4; field = strtok(NULL, "\t")) {
+			fields[fieldCount++] = field;
+		}
+		if (fieldCount < 4 || strtok(NULL, "\t") != NULL) {
+			_fail("malformed line: ", line);
+		}
+		*encodings = realloc(*encodings, (count + 1) * sizeof(Encoding));
+		(*encodings)[count++] = (Encoding) {
+			.name = strdup(fields[0]),
+			.fileName = strdup(fields[1]),
+			.firstLetter = _parseCodepoint(fields[2], line),
+			.lastLetter = _parseCodepoint(fields[3], line)};
+	}
+	fclose(file);
+	if (count == 0) {
+		_fail("no encodings in ", path);
+	}
+	return count;
+}
+
+int main(const int count, char ** arguments) {
+	if (count != 3) {
+		_fail("usage: EncodingTableGenerator <output.c> <data directory>", "");
+	}
+	Encoding * encodings = NULL;
+	const size_t encodingCount = _loadManifest(arguments[2], &encodings);
+
+	FILE * output = fopen(arguments[1], "w");
+	if (output == NULL) {
+		_fail("cannot create ", arguments[1]);
+	}
+	fprintf(output, "// Generated by EncodingTableGenerator from \"%s\". Do not edit.\n\n", arguments[2]);
+	fprintf(output, "#include \"frontend/lexical-analysis/EncodingTables.h\"\n\n");
+	for (size_t k = 0; k < encodingCount; ++k) {
+		_loadMapping(&encodings[k], arguments[2]);
+		_writeEncoding(output, &encodings[k], k);
+	}
+	fprintf(output, "const ByteEncoding byteEncodings[] = {\n");
+	for (size_t k = 0; k < encodingCount; ++k) {
+		const Encoding * encoding = &encodings[k];
+		fprintf(output, "\t{\"%s\", _encoding%zuSingles, ", encoding->name, k);
+		if (encoding->pairs != NULL) {
+			fprintf(output, "_encoding%zuPairs, ", k);
+		}
+		else {
+			fprintf(output, "0, ");
+		}
+		fprintf(output, "0x%02X, 0x%02X, 0x%02X, 0x%02X, 0x%04X, 0x%04X},\n",
+			encoding->firstLead, encoding->lastLead, encoding->firstTrail, encoding->lastTrail, encoding->firstLetter, encoding->lastLetter);
+		free(encoding->name);
+		free(encoding->fileName);
+		free(encoding->pairs);
+	}
+	fprintf(output, "\t{0, 0, 0, 0, 0, 0, 0, 0, 0}};\n");
+	free(encodings);
+	if (fclose(output) != 0) {
+		_fail("cannot write ", arguments[1]);
+	}
+	return EXIT_SUCCESS;
+}
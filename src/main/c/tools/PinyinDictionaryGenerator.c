@@ -0,0 +1,364 @@
+/**
+ * Generates the Chinese dictionary (see "PinyinDictionary.h") at build time,
+ * from a dictionary in the CC-CEDICT format, a line per entry as:
+ *
+ *	traditional simplified [pin1 yin1] /definition/.../
+ *
+ * Both forms of every word are keys, and their reading is written with tone
+ * marks (as "pīnyīn"). A word with many entries keeps the reading of its first
+ * one, so the dictionary lists the most common reading of a polyphone first.
+ * Lines that start with "#" are comments.
+ *
+ * The keys are compiled into a double-array trie over their UTF-8 bytes, that
+ * is written (with the readings) as a file to be mapped as it is.
+ *
+ * Usage: PinyinDictionaryGenerator <output.dat> <dictionary>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Keep in sync with "PinyinDictionary.h".
+#define DICTIONARY_MAGIC "PINYIN01"
+#define TERMINAL_LABEL 0
+#define FREE_UNIT -1
+
+#define MAXIMUM_READING 1024
+
+typedef struct {
+	char * key;
+	size_t length;
+	uint32_t reading;
+	size_t order;
+} Entry;
+
+typedef struct {
+	int32_t * base;
+	int32_t * check;
+	size_t unitCount;
+	// Every unit below is in use.
+	size_t firstFree;
+} DoubleArray;
+
+static void _fail(const char * message, const char * argument) {
+	fprintf(stderr, "PinyinDictionaryGenerator: %s%s\n", message, argument);
+	exit(EXIT_FAILURE);
+}
+
+static void * _grow(void * array, size_t count, size_t size) {
+	// Grows at every power of two.
+	if (count != 0 && (count & (count - 1)) != 0) {
+		return array;
+	}
+	void * grown = realloc(array, (count == 0 ? 1 : 2 * count) * size);
+	if (grown == NULL) {
+		_fail("out of memory", "");
+	}
+	return grown;
+}
+
+/* PINYIN */
+
+static const char * _toneMarks[2][6][4] = {
+	{{"ā", "á", "ǎ", "à"}, {"ē", "é", "ě", "è"}, {"ī", "í", "ǐ", "ì"}, {"ō", "ó", "ǒ", "ò"}, {"ū", "ú", "ǔ", "ù"}, {"ǖ", "ǘ", "ǚ", "ǜ"}},
+	{{"Ā", "Á", "Ǎ", "À"}, {"Ē", "É", "Ě", "È"}, {"Ī", "Í", "Ǐ", "Ì"}, {"Ō", "Ó", "Ǒ", "Ò"}, {"Ū", "Ú", "Ǔ", "Ù"}, {"Ǖ", "Ǘ", "Ǚ", "Ǜ"}}};
+
+// Returns the index of the vowel in "aeiouü" (where "ü" is "v"), or -1.
+static int _vowelIndex(char letter) {
+	const char * vowels = "aeiouv";
+	const char * vowel = letter == '\0' ? NULL : strchr(vowels, letter | 0x20);
+	return vowel == NULL ? -1 : (int) (vowel - vowels);
+}
+
+/**
+ * Appends a syllable (as "zhong1", or "lu:4") with its tone mark: on the "a" or
+ * the "e" if any, on the "o" of "ou", and on the last vowel otherwise. The
+ * neutral tone (5) has no mark. Anything else is appended as it is.
+ */
+static void _appendSyllable(char * reading, const char * syllable) {
+	char letters[64];
+	size_t length = 0;
+	for (const char * c = syllable; *c != '\0' && length < sizeof(letters) - 1; ++c) {
+		if (c[0] == 'u' && c[1] == ':') {
+			letters[length++] = 'v';
+			++c;
+		}
+		else if (c[0] == 'U' && c[1] == ':') {
+			letters[length++] = 'V';
+			++c;
+		}
+		else {
+			letters[length++] = *c;
+		}
+	}
+	letters[length] = '\0';
+	const int tone = 0 < length && '1' <= letters[length - 1] && letters[length - 1] <= '5' ? letters[length - 1] - '0' : 0;
+	if (tone == 0) {
+		strcat(reading, syllable);
+		return;
+	}
+	letters[--length] = '\0';
+
+	int marked = -1;
+	for (size_t k = 0; k < length && marked < 0; ++k) {
+		if ((letters[k] | 0x20) == 'a' || (letters[k] | 0x20) == 'e') {
+			marked = (int) k;
+		}
+	}
+	for (size_t k = 0; k + 1 < length && marked < 0; ++k) {
+		if ((letters[k] | 0x20) == 'o' && (letters[k + 1] | 0x20) == 'u') {
+			marked = (int) k;
+		}
+	}
+	for (size_t k = length; 0 < k && marked < 0; --k) {
+		if (0 <= _vowelIndex(letters[k - 1])) {
+			marked = (int) k - 1;
+		}
+	}
+
+	char * end = reading + strlen(reading);
+	for (size_t k = 0; k < length; ++k) {
+		const int vowel = _vowelIndex(letters[k]);
+		const int isUpper = 'A' <= letters[k] && letters[k] <= 'Z';
+		if ((int) k == marked && tone < 5) {
+			end += sprintf(end, "%s", _toneMarks[isUpper][vowel][tone - 1]);
+		}
+		else if (vowel == 5) {
+			end += sprintf(end, "%s", isUpper ? "Ü" : "ü");
+		}
+		else {
+			*end++ = letters[k];
+		}
+	}
+	*end = '\0';
+}
+
+/**
+ * Converts the syllables of a word into its reading, as a single word. An
+ * apostrophe separates a syllable that starts with "a", "o" or "e".
+ */
+static void _toReading(char * reading, char * syllables, const char * line) {
+	reading[0] = '\0';
+	for (char * syllable = strtok(syllables, " "); syllable != NULL; syllable = strtok(NULL, " ")) {
+		if (MAXIMUM_READING - 64 < strlen(reading)) {
+			_fail("reading too long in line: ", line);
+		}
+		const char first = syllable[0] | 0x20;
+		if (reading[0] != '\0' && (first == 'a' || first == 'o' || first == 'e')) {
+			strcat(reading, "'");
+		}
+		_appendSyllable(reading, syllable);
+	}
+}
+
+/* DICTIONARY */
+
+static int _compareEntries(const void * left, const void * right) {
+	const Entry * a = left;
+	const Entry * b = right;
+	const size_t length = a->length < b->length ? a->length : b->length;
+	const int bytes = memcmp(a->key, b->key, length);
+	if (bytes != 0) {
+		return bytes;
+	}
+	if (a->length != b->length) {
+		return a->length < b->length ? -1 : 1;
+	}
+	return (a->order > b->order) - (a->order < b->order);
+}
+
+static void _addEntry(Entry ** entries, size_t * count, const char * key, uint32_t reading) {
+	*entries = _grow(*entries, *count, sizeof(Entry));
+	(*entries)[*count] = (Entry) {.key = strdup(key), .length = strlen(key), .reading = reading, .order = *count};
+	++*count;
+}
+
+/**
+ * Loads the entries of the dictionary (two per word, if its forms differ),
+ * and their readings into the blob.
+ */
+static size_t _loadDictionary(const char * path, Entry ** entries, char ** blob, size_t * blobLength) {
+	FILE * file = fopen(path, "r");
+	if (file == NULL) {
+		_fail("cannot open ", path);
+	}
+	size_t count = 0;
+	char line[8192];
+	char copy[8192];
+	char reading[MAXIMUM_READING];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0' || line[0] == '#') {
+			continue;
+		}
+		strcpy(copy, line);
+		char * open = strchr(copy, '[');
+		char * close = open == NULL ? NULL : strchr(open, ']');
+		if (close == NULL) {
+			_fail("malformed line: ", line);
+		}
+		*open = '\0';
+		*close = '\0';
+		char * traditional = strtok(copy, " ");
+		char * simplified = strtok(NULL, " ");
+		if (traditional == NULL || simplified == NULL) {
+			_fail("malformed line: ", line);
+		}
+		_toReading(reading, open + 1, line);
+
+		const size_t length = strlen(reading) + 1;
+		*blob = realloc(*blob, *blobLength + length);
+		if (*blob == NULL || UINT32_MAX < *blobLength + length) {
+			_fail("the readings are too large, in ", path);
+		}
+		memcpy(*blob + *blobLength, reading, length);
+		_addEntry(entries, &count, simplified, (uint32_t) *blobLength);
+		if (strcmp(traditional, simplified) != 0) {
+			_addEntry(entries, &count, traditional, (uint32_t) *blobLength);
+		}
+		*blobLength += length;
+	}
+	fclose(file);
+	if (count == 0) {
+		_fail("no entries in ", path);
+	}
+	return count;
+}
+
+/* DOUBLE-ARRAY TRIE */
+
+static void _reserveUnits(DoubleArray * trie, size_t unitCount) {
+	if (unitCount <= trie->unitCount) {
+		return;
+	}
+	size_t capacity = trie->unitCount == 0 ? 1024 : trie->unitCount;
+	while (capacity < unitCount) {
+		capacity *= 2;
+	}
+	trie->base = realloc(trie->base, capacity * sizeof(int32_t));
+	trie->check = realloc(trie->check, capacity * sizeof(int32_t));
+	if (trie->base == NULL || trie->check == NULL || INT32_MAX < capacity) {
+		_fail("out of memory", "");
+	}
+	for (size_t k = trie->unitCount; k < capacity; ++k) {
+		trie->base[k] = 0;
+		trie->check[k] = FREE_UNIT;
+	}
+	trie->unitCount = capacity;
+}
+
+// Finds the first base where every label is free (the labels are sorted).
+static size_t _findBase(DoubleArray * trie, const unsigned int * labels, size_t labelCount) {
+	while (trie->firstFree < trie->unitCount && trie->check[trie->firstFree] != FREE_UNIT) {
+		++trie->firstFree;
+	}
+	for (size_t position = trie->firstFree > labels[0] ? trie->firstFree : labels[0] + 1;; ++position) {
+		_reserveUnits(trie, position + 257);
+		if (trie->check[position] != FREE_UNIT) {
+			continue;
+		}
+		const size_t base = position - labels[0];
+		size_t k = 1;
+		while (k < labelCount && trie->check[base + labels[k]] == FREE_UNIT) {
+			++k;
+		}
+		if (k == labelCount) {
+			return base;
+		}
+	}
+}
+
+static unsigned int _labelOf(const Entry * entry, size_t depth) {
+	return depth == entry->length ? TERMINAL_LABEL : (unsigned char) entry->key[depth] + 1u;
+}
+
+/**
+ * Places the children of the state, that are the entries (sorted and unique)
+ * from "first" to "last" with the same first "depth" bytes, and then their own.
+ */
+static void _buildState(DoubleArray * trie, size_t state, const Entry * entries, size_t first, size_t last, size_t depth) {
+	unsigned int labels[257] = {0};
+	size_t starts[258];
+	size_t labelCount = 0;
+	for (size_t k = first; k < last; ++k) {
+		const unsigned int label = _labelOf(&entries[k], depth);
+		if (labelCount == 0 || labels[labelCount - 1] != label) {
+			labels[labelCount] = label;
+			starts[labelCount++] = k;
+		}
+	}
+	starts[labelCount] = last;
+
+	const size_t base = _findBase(trie, labels, labelCount);
+	trie->base[state] = (int32_t) base;
+	for (size_t k = 0; k < labelCount; ++k) {
+		trie->check[base + labels[k]] = (int32_t) state;
+	}
+	for (size_t k = 0; k < labelCount; ++k) {
+		const size_t child = base + labels[k];
+		if (labels[k] == TERMINAL_LABEL) {
+			// A terminal unit holds the offset of the reading.
+			trie->base[child] = (int32_t) entries[starts[k]].reading;
+		}
+		else {
+			_buildState(trie, child, entries, starts[k], starts[k + 1], depth + 1);
+		}
+	}
+}
+
+int main(const int count, char ** arguments) {
+	if (count != 3) {
+		_fail("usage: PinyinDictionaryGenerator <output.dat> <dictionary>", "");
+	}
+	Entry * entries = NULL;
+	char * blob = NULL;
+	size_t blobLength = 0;
+	size_t entryCount = _loadDictionary(arguments[2], &entries, &blob, &blobLength);
+
+	// The first entry of every key is kept.
+	qsort(entries, entryCount, sizeof(Entry), _compareEntries);
+	size_t unique = 0;
+	for (size_t k = 0; k < entryCount; ++k) {
+		if (unique != 0 && entries[unique - 1].length == entries[k].length && memcmp(entries[unique - 1].key, entries[k].key, entries[k].length) == 0) {
+			free(entries[k].key);
+			continue;
+		}
+		entries[unique++] = entries[k];
+	}
+
+	// The root is the unit zero.
+	DoubleArray trie = {0};
+	_reserveUnits(&trie, 1024);
+	trie.check[0] = 0;
+	_buildState(&trie, 0, entries, 0, unique, 0);
+	size_t unitCount = trie.unitCount;
+	while (1 < unitCount && trie.check[unitCount - 1] == FREE_UNIT) {
+		--unitCount;
+	}
+
+	FILE * output = fopen(arguments[1], "wb");
+	if (output == NULL) {
+		_fail("cannot create ", arguments[1]);
+	}
+	const uint32_t header[2] = {(uint32_t) unitCount, (uint32_t) blobLength};
+	fwrite(DICTIONARY_MAGIC, 1, 8, output);
+	fwrite(header, sizeof(uint32_t), 2, output);
+	fwrite(trie.base, sizeof(int32_t), unitCount, output);
+	fwrite(trie.check, sizeof(int32_t), unitCount, output);
+	fwrite(blob, 1, blobLength, output);
+	if (fclose(output) != 0) {
+		_fail("cannot write ", arguments[1]);
+	}
+	fprintf(stdout, "PinyinDictionaryGenerator: %zu keys, %zu units, %zu bytes of readings.\n", unique, unitCount, blobLength);
+
+	for (size_t k = 0; k < unique; ++k) {
+		free(entries[k].key);
+	}
+	free(entries);
+	free(blob);
+	free(trie.base);
+	free(trie.check);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,749 @@
+/**
+ * Generates the transliteration tables (see "RomanizationTables.h") at build
+ * time, from the rule files of a directory. The schemes are listed in the
+ * "schemes.tsv" file of the directory, a line per scheme as:
+ *
+ *	language<tab>scheme<tab>table<tab>rules[<tab>sound changes]
+ *
+ * where the language is the code of the "lang" parameter, the table names the
+ * generated table, and the last fields are files of the directory. The first
+ * scheme of a language is its default one. Every rule is a line as:
+ *
+ *	U+XXXX[ U+YYYY...]<tab>romanization[<tab>context]
+ *
+ * where the input is a sequence of codepoints, "-" is an empty romanization,
+ * and the optional context is "initial", "final" or "word" (both). Lines that
+ * start with "#" are comments. The rules of a language are compiled into a
+ * trie, with a blob of romanizations of its own.
+ *
+ * The Korean files romanize the conjoining jamo, since syllables are decomposed
+ * before the rules apply. Besides their own rules, a rule per pair of a final
+ * and the initial that follows it is compiled from the sound changes of the
+ * language, as lines of the form:
+ *
+ *	U+XXXX U+YYYY[ U+ZZZZ]<tab>U+XXXX[ U+YYYY...][<tab># comment]
+ *
+ * where the jamo of the input are pronounced as the jamo of the output (and
+ * then romanized with the rules). So assimilation and liaison happen in the
+ * same single pass as the rest of the transliteration.
+ *
+ * The schemes that can also convert romanized text back into the native script
+ * are listed in the "inverses.tsv" file of the directory, a line per scheme:
+ *
+ *	language<tab>scheme<tab>table[<tab>rules]
+ *
+ * where the table names the inverse table, that is compiled from the rules of
+ * the scheme with their inputs and romanizations swapped (and without any sound
+ * change). The optional rules, of the same form, are swapped first, so they
+ * take precedence: they tell apart the letters that are romanized alike. Among
+ * the rest, the first one of a romanization is kept, but for Korean, where it
+ * takes every single jamo (as the structure of a syllable tells which one it
+ * is).
+ *
+ * Every table is registered in "romanizationSchemes", by language and scheme.
+ *
+ * Usage: RomanizationTableGenerator <output.c> <data directory>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MANIFEST_FILE_NAME "schemes.tsv"
+#define INVERSES_FILE_NAME "inverses.tsv"
+#define MAXIMUM_CODEPOINT 0x10FFFF
+#define MAXIMUM_BLOB_LENGTH 0xFFFF
+// Keep in sync with TRANSLITERATION_MAXIMUM_DEPTH.
+#define MAXIMUM_DEPTH 8
+
+#define CONTEXT_INITIAL 1
+#define CONTEXT_FINAL 2
+
+#define HANGUL_FIRST_INITIAL 0x1100
+#define HANGUL_LAST_INITIAL 0x1112
+#define HANGUL_FIRST_FINAL 0x11A8
+#define HANGUL_LAST_FINAL 0x11C2
+#define HANGUL_FINAL_NIEUN 0x11AB
+#define HANGUL_FINAL_RIEUL 0x11AF
+#define HANGUL_FINAL_MIEUM 0x11B7
+#define HANGUL_FINAL_IEUNG 0x11BC
+
+typedef struct {
+	uint32_t input[MAXIMUM_DEPTH];
+	size_t length;
+	char * output;
+	unsigned int context;
+} Rule;
+
+/**
+ * A sound change: the input is pronounced as the output.
+ */
+typedef struct {
+	uint32_t input[MAXIMUM_DEPTH];
+	size_t length;
+	uint32_t output[MAXIMUM_DEPTH];
+	size_t outputLength;
+} SoundChange;
+
+/**
+ * A node of the trie while it's built. Its children and rules are indexes, so
+ * they survive the growth of the arrays.
+ */
+typedef struct {
+	uint32_t key;
+	size_t * children;
+	size_t childCount;
+	size_t * rules;
+	size_t ruleCount;
+	size_t index;
+} TrieNode;
+
+typedef struct {
+	char * language;
+	char * scheme;
+	char * name;
+	char * fileName;
+	// The sound changes between syllables, if any.
+	char * changesFileName;
+	// The inverse table and its own rules, if any.
+	char * inverseName;
+	char * inverseFileName;
+	Rule * rules;
+	size_t ruleCount;
+	TrieNode * nodes;
+	size_t nodeCount;
+} Language;
+
+static const Rule * _sortedRules = NULL;
+static const TrieNode * _sortedNodes = NULL;
+
+static void _fail(const char * message, const char * argument) {
+	fprintf(stderr, "RomanizationTableGenerator: %s%s\n", message, argument);
+	exit(EXIT_FAILURE);
+}
+
+static void * _grow(void * array, size_t count, size_t size) {
+	// Grows at every power of two.
+	if (count != 0 && (count & (count - 1)) != 0) {
+		return array;
+	}
+	void * grown = realloc(array, (count == 0 ? 1 : 2 * count) * size);
+	if (grown == NULL) {
+		_fail("out of memory", "");
+	}
+	return grown;
+}
+
+static void _addRule(Language * language, const Rule * rule) {
+	language->rules = _grow(language->rules, language->ruleCount, sizeof(Rule));
+	language->rules[language->ruleCount++] = *rule;
+}
+
+// Decodes the (valid) UTF-8 text, and returns its length in codepoints.
+static size_t _decodeUtf8(const char * text, uint32_t * codepoints, size_t capacity, const char * fileName) {
+	size_t length = 0;
+	for (const unsigned char * c = (const unsigned char *) text; *c != '\0'; ++length) {
+		const size_t size = *c < 0x80 ? 1 : *c < 0xE0 ? 2 : *c < 0xF0 ? 3 : 4;
+		uint32_t codepoint = size == 1 ? *c : *c & (0x7F >> size);
+		for (size_t k = 1; k < size; ++k) {
+			if ((c[k] & 0xC0) != 0x80) {
+				_fail("invalid UTF-8 in ", fileName);
+			}
+			codepoint = codepoint << 6 | (c[k] & 0x3F);
+		}
+		if (capacity <= length) {
+			_fail("romanization too long to be inverted, in ", fileName);
+		}
+		codepoints[length] = codepoint;
+		c += size;
+	}
+	return length;
+}
+
+// Encodes the codepoints in UTF-8, as a new string.
+static char * _encodeUtf8(const uint32_t * codepoints, size_t length) {
+	char * text = calloc(4 * length + 1, 1);
+	char * end = text;
+	for (size_t k = 0; k < length; ++k) {
+		const uint32_t c = codepoints[k];
+		if (c < 0x80) {
+			*end++ = (char) c;
+		}
+		else if (c < 0x800) {
+			*end++ = (char) (0xC0 | c >> 6);
+			*end++ = (char) (0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000) {
+			*end++ = (char) (0xE0 | c >> 12);
+			*end++ = (char) (0x80 | (c >> 6 & 0x3F));
+			*end++ = (char) (0x80 | (c & 0x3F));
+		}
+		else {
+			*end++ = (char) (0xF0 | c >> 18);
+			*end++ = (char) (0x80 | (c >> 12 & 0x3F));
+			*end++ = (char) (0x80 | (c >> 6 & 0x3F));
+			*end++ = (char) (0x80 | (c & 0x3F));
+		}
+	}
+	return text;
+}
+
+static unsigned int _parseContext(const char * context, const char * line) {
+	if (context == NULL || strcmp(context, "") == 0) {
+		return 0;
+	}
+	if (strcmp(context, "initial") == 0) {
+		return CONTEXT_INITIAL;
+	}
+	if (strcmp(context, "final") == 0) {
+		return CONTEXT_FINAL;
+	}
+	if (strcmp(context, "word") == 0) {
+		return CONTEXT_INITIAL | CONTEXT_FINAL;
+	}
+	_fail("unknown context in line: ", line);
+	return 0;
+}
+
+// Parses a sequence of codepoints separated by spaces, and returns its length.
+static size_t _parseCodepoints(char * text, uint32_t * codepoints, const char * line) {
+	size_t length = 0;
+	for (char * codepoint = strtok(text, " "); codepoint != NULL; codepoint = strtok(NULL, " ")) {
+		unsigned int value;
+		char extra;
+		if (MAXIMUM_DEPTH <= length || sscanf(codepoint, "U+%X%c", &value, &extra) != 1 || MAXIMUM_CODEPOINT < value) {
+			_fail("malformed input in line: ", line);
+		}
+		codepoints[length++] = value;
+	}
+	if (length == 0) {
+		_fail("malformed input in line: ", line);
+	}
+	return length;
+}
+
+/**
+ * Loads the rules of a file into the language.
+ */
+static void _loadRules(Language * language, const char * directory) {
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/%s", directory, language->fileName);
+	FILE * file = fopen(path, "r");
+	if (file == NULL) {
+		_fail("cannot open ", path);
+	}
+	char line[1024];
+	char copy[1024];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0' || line[0] == '#') {
+			continue;
+		}
+		strcpy(copy, line);
+		char * input = strtok(copy, "\t");
+		char * output = strtok(NULL, "\t");
+		char * context = strtok(NULL, "\t");
+		if (input == NULL || output == NULL) {
+			_fail("malformed line: ", line);
+		}
+		Rule rule = {.length = 0, .context = _parseContext(context, line)};
+		rule.length = _parseCodepoints(input, rule.input, line);
+		rule.output = strdup(strcmp(output, "-") == 0 ? "" : output);
+		_addRule(language, &rule);
+	}
+	fclose(file);
+}
+
+/**
+ * Loads the sound changes of the language, and returns how many there are.
+ */
+static size_t _loadSoundChanges(const Language * language, const char * directory, SoundChange ** changes) {
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/%s", directory, language->changesFileName);
+	FILE * file = fopen(path, "r");
+	if (file == NULL) {
+		_fail("cannot open ", path);
+	}
+	size_t count = 0;
+	char line[1024];
+	char copy[1024];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0' || line[0] == '#') {
+			continue;
+		}
+		strcpy(copy, line);
+		// An optional third field is a comment.
+		char * tab = strchr(copy, '\t');
+		char * comment = tab == NULL ? NULL : strchr(tab + 1, '\t');
+		if (tab == NULL || (comment != NULL && comment[1] != '#')) {
+			_fail("malformed line: ", line);
+		}
+		*tab = '\0';
+		if (comment != NULL) {
+			*comment = '\0';
+		}
+		*changes = _grow(*changes, count, sizeof(SoundChange));
+		SoundChange * change = &(*changes)[count++];
+		change->length = _parseCodepoints(copy, change->input, line);
+		change->outputLength = _parseCodepoints(tab + 1, change->output, line);
+		if (change->length < 2) {
+			_fail("a sound change needs a final and an initial, in line: ", line);
+		}
+	}
+	fclose(file);
+	return count;
+}
+
+// Returns the rule (among the first ones) of exactly the input and context, if any.
+static const Rule * _findRule(const Language * language, size_t ruleCount, const uint32_t * input, size_t length, unsigned int context) {
+	for (size_t k = 0; k < ruleCount; ++k) {
+		const Rule * rule = &language->rules[k];
+		if (rule->length == length && rule->context == context && memcmp(rule->input, input, length * sizeof(uint32_t)) == 0) {
+			return rule;
+		}
+	}
+	return NULL;
+}
+
+// A final that stops the voice (every one but the nasals and the liquid).
+static int _isObstruentFinal(uint32_t jamo) {
+	return HANGUL_FIRST_FINAL <= jamo && jamo <= HANGUL_LAST_FINAL && jamo != HANGUL_FINAL_NIEUN
+		&& jamo != HANGUL_FINAL_RIEUL && jamo != HANGUL_FINAL_MIEUM && jamo != HANGUL_FINAL_IEUNG;
+}
+
+/**
+ * Romanizes a sequence of jamo with the rules of the file (the first ones),
+ * preferring the rules of two jamo. An initial after an obstruent final takes
+ * its word-initial form (if it has one), since it's voiceless there as well.
+ */
+static char * _romanizeJamo(const Language * language, size_t ruleCount, const uint32_t * jamo, size_t length) {
+	char romanization[256] = "";
+	for (size_t k = 0; k < length;) {
+		size_t consumed = 2;
+		const Rule * rule = k + 1 < length ? _findRule(language, ruleCount, jamo + k, 2, 0) : NULL;
+		if (rule == NULL) {
+			consumed = 1;
+			if (0 < k && _isObstruentFinal(jamo[k - 1])) {
+				rule = _findRule(language, ruleCount, jamo + k, 1, CONTEXT_INITIAL);
+			}
+			if (rule == NULL) {
+				rule = _findRule(language, ruleCount, jamo + k, 1, 0);
+			}
+		}
+		if (rule == NULL) {
+			_fail("missing Hangul jamo in ", language->fileName);
+		}
+		if (sizeof(romanization) <= strlen(romanization) + strlen(rule->output)) {
+			_fail("romanization too long in ", language->fileName);
+		}
+		strcat(romanization, rule->output);
+		k += consumed;
+	}
+	return strdup(romanization);
+}
+
+/**
+ * Adds a rule per pair of a final and an initial, romanized as it sounds
+ * after the sound changes, and a rule per longer sound change. An explicit
+ * rule of a pair takes precedence over its sound changes.
+ */
+static void _compileSoundChanges(Language * language, const char * directory) {
+	SoundChange * changes = NULL;
+	const size_t changeCount = _loadSoundChanges(language, directory, &changes);
+	const size_t ruleCount = language->ruleCount;
+	for (uint32_t final = HANGUL_FIRST_FINAL; final <= HANGUL_LAST_FINAL; ++final) {
+		for (uint32_t initial = HANGUL_FIRST_INITIAL; initial <= HANGUL_LAST_INITIAL; ++initial) {
+			Rule rule = {.input = {final, initial}, .length = 2, .context = 0};
+			if (_findRule(language, ruleCount, rule.input, rule.length, 0) != NULL) {
+				continue;
+			}
+			rule.output = _romanizeJamo(language, ruleCount, rule.input, rule.length);
+			for (size_t k = 0; k < changeCount; ++k) {
+				if (changes[k].length == 2 && changes[k].input[0] == final && changes[k].input[1] == initial) {
+					free(rule.output);
+					rule.output = _romanizeJamo(language, ruleCount, changes[k].output, changes[k].outputLength);
+					break;
+				}
+			}
+			_addRule(language, &rule);
+		}
+	}
+	for (size_t k = 0; k < changeCount; ++k) {
+		if (2 < changes[k].length) {
+			Rule rule = {.length = changes[k].length, .context = 0};
+			memcpy(rule.input, changes[k].input, changes[k].length * sizeof(uint32_t));
+			rule.output = _romanizeJamo(language, ruleCount, changes[k].output, changes[k].outputLength);
+			_addRule(language, &rule);
+		}
+	}
+	free(changes);
+}
+
+static int _isJamo(uint32_t codepoint) {
+	return HANGUL_FIRST_INITIAL <= codepoint && codepoint <= HANGUL_LAST_FINAL;
+}
+
+/**
+ * Adds the rules to the inverse table, with their inputs and romanizations
+ * swapped. An empty romanization can't be inverted. If "everyJamo", every
+ * single jamo of a romanization is kept (as its candidates, in order), and
+ * the rules of many jamo are skipped.
+ */
+static void _invertRules(Language * inverse, const Rule * rules, size_t ruleCount, int everyJamo) {
+	for (size_t k = 0; k < ruleCount; ++k) {
+		const Rule * rule = &rules[k];
+		if (rule->output[0] == '\0' || (everyJamo && (rule->length != 1 || !_isJamo(rule->input[0])))) {
+			continue;
+		}
+		Rule inverted = {.context = rule->context};
+		inverted.length = _decodeUtf8(rule->output, inverted.input, MAXIMUM_DEPTH, inverse->fileName);
+		Rule * existing = (Rule *) _findRule(inverse, inverse->ruleCount, inverted.input, inverted.length, inverted.context);
+		if (existing == NULL) {
+			inverted.output = _encodeUtf8(rule->input, rule->length);
+			_addRule(inverse, &inverted);
+		}
+		else if (everyJamo) {
+			char * candidate = _encodeUtf8(rule->input, rule->length);
+			existing->output = realloc(existing->output, strlen(existing->output) + strlen(candidate) + 1);
+			strcat(existing->output, candidate);
+			free(candidate);
+		}
+	}
+}
+
+/**
+ * Compiles the inverse table of the language, from its own rules (if any) and
+ * then from the ones of the language, before its sound changes are compiled.
+ */
+static void _compileInverse(Language * inverse, const Language * language, const char * directory) {
+	*inverse = (Language) {.name = strdup(language->inverseName), .fileName = strdup(language->fileName)};
+	const int everyJamo = language->changesFileName != NULL;
+	if (language->inverseFileName != NULL) {
+		Language own = {.fileName = language->inverseFileName};
+		_loadRules(&own, directory);
+		_invertRules(inverse, own.rules, own.ruleCount, everyJamo);
+		for (size_t k = 0; k < own.ruleCount; ++k) {
+			free(own.rules[k].output);
+		}
+		free(own.rules);
+	}
+	_invertRules(inverse, language->rules, language->ruleCount, everyJamo);
+}
+
+static size_t _addNode(Language * language, uint32_t key) {
+	language->nodes = _grow(language->nodes, language->nodeCount, sizeof(TrieNode));
+	language->nodes[language->nodeCount] = (TrieNode) {.key = key};
+	return language->nodeCount++;
+}
+
+static size_t _findChild(Language * language, size_t node, uint32_t key) {
+	for (size_t k = 0; k < language->nodes[node].childCount; ++k) {
+		const size_t child = language->nodes[node].children[k];
+		if (language->nodes[child].key == key) {
+			return child;
+		}
+	}
+	const size_t child = _addNode(language, key);
+	TrieNode * parent = &language->nodes[node];
+	parent->children = _grow(parent->children, parent->childCount, sizeof(size_t));
+	parent->children[parent->childCount++] = child;
+	return child;
+}
+
+static int _compareNodes(const void * left, const void * right) {
+	const uint32_t a = _sortedNodes[*(const size_t *) left].key;
+	const uint32_t b = _sortedNodes[*(const size_t *) right].key;
+	return (a > b) - (a < b);
+}
+
+// The most specific context first, and otherwise, in the order of the file.
+static int _compareRules(const void * left, const void * right) {
+	const size_t a = *(const size_t *) left;
+	const size_t b = *(const size_t *) right;
+	const int specificity = __builtin_popcount(_sortedRules[b].context) - __builtin_popcount(_sortedRules[a].context);
+	return specificity != 0 ? specificity : (a > b) - (a < b);
+}
+
+/**
+ * Builds the trie of the rules, where the node zero is a virtual root.
+ */
+static void _buildTrie(Language * language) {
+	_addNode(language, 0);
+	for (size_t k = 0; k < language->ruleCount; ++k) {
+		size_t node = 0;
+		for (size_t j = 0; j < language->rules[k].length; ++j) {
+			node = _findChild(language, node, language->rules[k].input[j]);
+		}
+		TrieNode * end = &language->nodes[node];
+		for (size_t j = 0; j < end->ruleCount; ++j) {
+			if (language->rules[end->rules[j]].context == language->rules[k].context) {
+				_fail("duplicated rule for ", language->rules[k].output);
+			}
+		}
+		end->rules = _grow(end->rules, end->ruleCount, sizeof(size_t));
+		end->rules[end->ruleCount++] = k;
+	}
+	_sortedNodes = language->nodes;
+	_sortedRules = language->rules;
+	for (size_t k = 0; k < language->nodeCount; ++k) {
+		qsort(language->nodes[k].children, language->nodes[k].childCount, sizeof(size_t), _compareNodes);
+		qsort(language->nodes[k].rules, language->nodes[k].ruleCount, sizeof(size_t), _compareRules);
+	}
+}
+
+/**
+ * Writes the blob as a string literal, a line per 64 characters. Every
+ * non-alphanumeric character is written in octal, so it's always valid C.
+ */
+static void _writeBlob(FILE * output, const char * name, const char * blob, size_t length) {
+	fprintf(output, "static const char _%sBlob[] =\n", name);
+	for (size_t k = 0; k < length || k == 0; k += 64) {
+		fprintf(output, "\t\"");
+		for (size_t j = k; j < k + 64 && j < length; ++j) {
+			const unsigned char character = blob[j];
+			if (('a' <= character && character <= 'z') || ('A' <= character && character <= 'Z') || ('0' <= character && character <= '9')) {
+				fputc(character, output);
+			}
+			else {
+				fprintf(output, "\\%03o", character);
+			}
+		}
+		fprintf(output, "\"%s\n", length <= k + 64 ? ";" : "");
+	}
+}
+
+/**
+ * Writes the trie in breadth-first order, so the children of every node are
+ * contiguous, as the roots are.
+ */
+static void _writeTable(FILE * output, Language * language) {
+	const TrieNode * root = &language->nodes[0];
+	if (root->childCount == 0) {
+		_fail("no rules in ", language->fileName);
+	}
+	size_t * order = calloc(language->nodeCount, sizeof(size_t));
+	size_t orderCount = 0;
+	for (size_t k = 0; k < root->childCount; ++k) {
+		order[orderCount++] = root->children[k];
+	}
+	for (size_t k = 0; k < orderCount; ++k) {
+		const TrieNode * node = &language->nodes[order[k]];
+		for (size_t j = 0; j < node->childCount; ++j) {
+			order[orderCount++] = node->children[j];
+		}
+	}
+	for (size_t k = 0; k < orderCount; ++k) {
+		language->nodes[order[k]].index = k;
+	}
+
+	const uint32_t first = language->nodes[root->children[0]].key;
+	const uint32_t last = language->nodes[root->children[root->childCount - 1]].key;
+	fprintf(output, "static const uint32_t _%sRoots[] = {", language->name);
+	for (uint32_t codepoint = first, k = 0; codepoint <= last; ++codepoint) {
+		const TrieNode * node = &language->nodes[root->children[k]];
+		const size_t value = node->key == codepoint ? node->index + 1 : 0;
+		k += node->key == codepoint;
+		fprintf(output, "%s%zu,", (codepoint - first) % 16 == 0 ? "\n\t" : " ", value);
+	}
+	fprintf(output, "\n};\n");
+
+	fprintf(output, "static const uint32_t _%sKeys[] = {", language->name);
+	for (size_t k = 0; k < orderCount; ++k) {
+		fprintf(output, "%s0x%04X,", k % 8 == 0 ? "\n\t" : " ", language->nodes[order[k]].key);
+	}
+	fprintf(output, "\n};\n");
+
+	size_t rule = 0;
+	fprintf(output, "static const TransliterationNode _%sNodes[] = {", language->name);
+	for (size_t k = 0; k < orderCount; ++k) {
+		const TrieNode * node = &language->nodes[order[k]];
+		const size_t firstChild = node->childCount == 0 ? 0 : language->nodes[node->children[0]].index;
+		fprintf(output, "%s{%zu, %zu, %zu, %zu},", k % 4 == 0 ? "\n\t" : " ", firstChild, rule, node->childCount, node->ruleCount);
+		rule += node->ruleCount;
+	}
+	fprintf(output, "\n};\n");
+
+	// The romanizations are written to the blob in the order of the rules.
+	char blob[MAXIMUM_BLOB_LENGTH];
+	size_t blobLength = 0;
+	unsigned int depth = 0;
+	fprintf(output, "static const TransliterationRule _%sRules[] = {", language->name);
+	for (size_t k = 0, count = 0; k < orderCount; ++k) {
+		const TrieNode * node = &language->nodes[order[k]];
+		for (size_t j = 0; j < node->ruleCount; ++j, ++count) {
+			const Rule * current = &language->rules[node->rules[j]];
+			const size_t length = strlen(current->output);
+			if (MAXIMUM_BLOB_LENGTH < blobLength + length) {
+				_fail("the blob is too large for 16-bit offsets, in ", language->fileName);
+			}
+			fprintf(output, "%s{%zu, %zu, %u},", count % 4 == 0 ? "\n\t" : " ", blobLength, length, current->context);
+			memcpy(blob + blobLength, current->output, length);
+			blobLength += length;
+			depth = depth < current->length ? current->length : depth;
+		}
+	}
+	fprintf(output, "\n};\n");
+	_writeBlob(output, language->name, blob, blobLength);
+
+	fprintf(output, "static const TransliterationTable _%sTransliteration = {\n", language->name);
+	fprintf(output, "\t0x%04X, %u, _%sRoots, _%sNodes, _%sKeys, _%sRules, _%sBlob, %u};\n\n",
+		first, last - first + 1, language->name, language->name, language->name, language->name, language->name, depth);
+	free(order);
+}
+
+static void _releaseLanguage(Language * language) {
+	for (size_t k = 0; k < language->ruleCount; ++k) {
+		free(language->rules[k].output);
+	}
+	for (size_t k = 0; k < language->nodeCount; ++k) {
+		free(language->nodes[k].children);
+		free(language->nodes[k].rules);
+	}
+	free(language->rules);
+	free(language->nodes);
+	free(language->language);
+	free(language->scheme);
+	free(language->name);
+	free(language->fileName);
+	free(language->changesFileName);
+	free(language->inverseName);
+	free(language->inverseFileName);
+}
+
+/**
+ * Loads the schemes of the manifest, and returns how many there are.
+ */
+static size_t _loadManifest(const char * directory, Language ** languages) {
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/%s", directory, MANIFEST_FILE_NAME);
+	FILE * file = fopen(path, "r");
+	if (file == NULL) {
+		_fail("cannot open ", path);
+	}
+	size_t count = 0;
+	char line[1024];
+	char copy[1024];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0' || line[0] == '#') {
+			continue;
+		}
+		strcpy(copy, line);
+		char * fields[5] = {NULL};
+		size_t fieldCount = 0;
+		for (char * field = strtok(copy, "\t"); field != NULL && fieldCount < 5; field = strtok(NULL, "\t")) {
+			fields[fieldCount++] = field;
+		}
+		if (fieldCount < 4 || strtok(NULL, "\t") != NULL) {
+			_fail("malformed line: ", line);
+		}
+		for (size_t k = 0; k < count; ++k) {
+			if (strcmp((*languages)[k].language, fields[0]) == 0 && strcmp((*languages)[k].scheme, fields[1]) == 0) {
+				_fail("duplicated scheme in line: ", line);
+			}
+		}
+		*languages = _grow(*languages, count, sizeof(Language));
+		(*languages)[count++] = (Language) {
+			.language = strdup(fields[0]),
+			.scheme = strdup(fields[1]),
+			.name = strdup(fields[2]),
+			.fileName = strdup(fields[3]),
+			.changesFileName = fields[4] == NULL ? NULL : strdup(fields[4])};
+	}
+	fclose(file);
+	if (count == 0) {
+		_fail("no schemes in ", path);
+	}
+	return count;
+}
+
+/**
+ * Loads the inverse tables of the schemes, from their manifest.
+ */
+static void _loadInverses(const char * directory, Language * languages, size_t languageCount) {
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/%s", directory, INVERSES_FILE_NAME);
+	FILE * file = fopen(path, "r");
+	if (file == NULL) {
+		_fail("cannot open ", path);
+	}
+	char line[1024];
+	char copy[1024];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0' || line[0] == '#') {
+			continue;
+		}
+		strcpy(copy, line);
+		char * fields[4] = {NULL};
+		size_t fieldCount = 0;
+		for (char * field = strtok(copy, "\t"); field != NULL && fieldCount < 4; field = strtok(NULL, "\t")) {
+			fields[fieldCount++] = field;
+		}
+		if (fieldCount < 3 || strtok(NULL, "\t") != NULL) {
+			_fail("malformed line: ", line);
+		}
+		Language * language = NULL;
+		for (size_t k = 0; k < languageCount && language == NULL; ++k) {
+			if (strcmp(languages[k].language, fields[0]) == 0 && strcmp(languages[k].scheme, fields[1]) == 0) {
+				language = &languages[k];
+			}
+		}
+		if (language == NULL || language->inverseName != NULL) {
+			_fail("unknown or duplicated scheme in line: ", line);
+		}
+		language->inverseName = strdup(fields[2]);
+		language->inverseFileName = fields[3] == NULL ? NULL : strdup(fields[3]);
+	}
+	fclose(file);
+}
+
+int main(const int count, char ** arguments) {
+	if (count != 3) {
+		_fail("usage: RomanizationTableGenerator <output.c> <data directory>", "");
+	}
+	Language * languages = NULL;
+	const size_t languageCount = _loadManifest(arguments[2], &languages);
+	_loadInverses(arguments[2], languages, languageCount);
+
+	FILE * output = fopen(arguments[1], "w");
+	if (output == NULL) {
+		_fail("cannot create ", arguments[1]);
+	}
+	fprintf(output, "// Generated by RomanizationTableGenerator from \"%s\". Do not edit.\n\n", arguments[2]);
+	fprintf(output, "#include \"backend/romanizers/RomanizationTables.h\"\n\n");
+	for (size_t k = 0; k < languageCount; ++k) {
+		_loadRules(&languages[k], arguments[2]);
+		if (languages[k].inverseName != NULL) {
+			Language inverse;
+			_compileInverse(&inverse, &languages[k], arguments[2]);
+			_buildTrie(&inverse);
+			_writeTable(output, &inverse);
+			_releaseLanguage(&inverse);
+		}
+		if (languages[k].changesFileName != NULL) {
+			_compileSoundChanges(&languages[k], arguments[2]);
+		}
+		_buildTrie(&languages[k]);
+		_writeTable(output, &languages[k]);
+	}
+	fprintf(output, "const RomanizationScheme romanizationSchemes[] = {\n");
+	for (size_t k = 0; k < languageCount; ++k) {
+		fprintf(output, "\t{\"%s\", \"%s\", &_%sTransliteration, ", languages[k].language, languages[k].scheme, languages[k].name);
+		if (languages[k].inverseName != NULL) {
+			fprintf(output, "&_%sTransliteration},\n", languages[k].inverseName);
+		}
+		else {
+			fprintf(output, "0},\n");
+		}
+		_releaseLanguage(&languages[k]);
+	}
+	fprintf(output, "\t{0, 0, 0, 0}};\n");
+	free(languages);
+	if (fclose(output) != 0) {
+		_fail("cannot write ", arguments[1]);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,314 @@
+/**
+ * Measures the throughput of the romanizers (see "romanize.h"), for every
+ * scheme of "romanizationSchemes" and for pinyin, over corpora of their
+ * language:
+ *
+ *	- "words": short words (of 2 to 8 letters), a call per word;
+ *	- "passage": a long passage of words, in a single call;
+ *	- "mixed": a long passage where ASCII and native words alternate;
+ *	- "real": the passages of the real corpus, a call per passage.
+ *
+ * The generated corpora are made of the letters of the real one, with a fixed
+ * seed, so they are the same in every run. The real corpus is a file of lines
+ * as "language<tab>text" (and comments that start with "#").
+ *
+ * Every corpus is romanized with "appendRomanization" (into a builder that is
+ * reused) and with "romanize" (into a new string per call), again and again
+ * for at least the given seconds. Every case is written as a line of values
+ * separated by tabs, after a header line:
+ *
+ *	language scheme corpus api calls bytes codepoints seconds megabytes_per_second codepoints_per_second allocations_per_call
+ *
+ * where a megabyte is 10^6 bytes of input. The allocations are counted when
+ * "malloc", "calloc" and "realloc" are wrapped at link time (with GNU ld),
+ * and are "NA" otherwise.
+ *
+ * Usage: RomanizerBenchmark [corpus.tsv] [seconds]
+ */
+
+#include "../backend/romanizers/PinyinDictionary.h"
+#include "../backend/romanizers/ScriptClassifier.h"
+#include "../backend/romanizers/romanize.h"
+#include "../shared/StringBuilder.h"
+#include "../shared/Utf8.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef BENCHMARK_CORPUS_PATH
+	#define BENCHMARK_CORPUS_PATH "src/main/resources/benchmark/corpus.tsv"
+#endif
+
+#define DEFAULT_SECONDS 0.25
+#define MAXIMUM_LINE 65536
+#define MAXIMUM_ALPHABET 1024
+#define WORD_COUNT 1024
+#define PASSAGE_LENGTH (64 * 1024)
+#define RANDOM_SEED 0x9E3779B97F4A7C15ull
+
+typedef struct {
+	char ** texts;
+	size_t count;
+	size_t bytes;
+	size_t codepoints;
+} Corpus;
+
+typedef struct {
+	uint32_t letters[MAXIMUM_ALPHABET];
+	size_t count;
+} Alphabet;
+
+typedef enum {
+	API_APPEND,
+	API_ROMANIZE
+} Api;
+
+#if defined(COUNT_ALLOCATIONS)
+static size_t _allocations = 0;
+
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t count, size_t size);
+void * __real_realloc(void * pointer, size_t size);
+
+void * __wrap_malloc(size_t size) {
+	++_allocations;
+	return __real_malloc(size);
+}
+
+void * __wrap_calloc(size_t count, size_t size) {
+	++_allocations;
+	return __real_calloc(count, size);
+}
+
+void * __wrap_realloc(void * pointer, size_t size) {
+	++_allocations;
+	return __real_realloc(pointer, size);
+}
+#endif
+
+static void _fail(const char * message, const char * detail) {
+	fprintf(stderr, "RomanizerBenchmark: %s%s\n", message, detail);
+	exit(EXIT_FAILURE);
+}
+
+static double _now() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// A xorshift generator, so the corpora don't depend on the C library.
+static uint64_t _random(uint64_t * state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+static size_t _countCodepoints(const char * text) {
+	size_t count = 0;
+	for (; *text != '\0'; ++text) {
+		count += (*text & 0xC0) != 0x80;
+	}
+	return count;
+}
+
+static void _addText(Corpus * corpus, const char * text) {
+	corpus->texts = realloc(corpus->texts, (corpus->count + 1) * sizeof(char *));
+	corpus->texts[corpus->count++] = strdup(text);
+	corpus->bytes += strlen(text);
+	corpus->codepoints += _countCodepoints(text);
+}
+
+static void _releaseCorpus(Corpus * corpus) {
+	for (size_t k = 0; k < corpus->count; ++k) {
+		free(corpus->texts[k]);
+	}
+	free(corpus->texts);
+	*corpus = (Corpus) {0};
+}
+
+static void _loadRealCorpus(Corpus * corpus, const char * path, const char * language) {
+	FILE * file = fopen(path, "r");
+	if (file == NULL) {
+		_fail("cannot open ", path);
+	}
+	char * line = malloc(MAXIMUM_LINE);
+	const size_t languageLength = strlen(language);
+	while (fgets(line, MAXIMUM_LINE, file) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '#' || strncmp(line, language, languageLength) != 0 || line[languageLength] != '\t') {
+			continue;
+		}
+		_addText(corpus, line + languageLength + 1);
+	}
+	free(line);
+	fclose(file);
+}
+
+// The letters are the codepoints of the real corpus that are in a script (so not spaces or punctuation).
+static void _collectAlphabet(Alphabet * alphabet, const Corpus * corpus) {
+	uint32_t codepoints[ROMANIZER_WINDOW];
+	alphabet->count = 0;
+	for (size_t k = 0; k < corpus->count; ++k) {
+		const char * text = corpus->texts[k];
+		const size_t length = strlen(text);
+		size_t consumed = 0;
+		for (size_t offset = 0; offset < length; offset += consumed) {
+			const size_t count = decodeUtf8(text + offset, length - offset, codepoints, ROMANIZER_WINDOW, &consumed);
+			for (size_t j = 0; j < count; ++j) {
+				if (classifyCodepoint(codepoints[j]) == SCRIPT_NEUTRAL) {
+					continue;
+				}
+				size_t letter = 0;
+				while (letter < alphabet->count && alphabet->letters[letter] != codepoints[j]) {
+					++letter;
+				}
+				if (letter == alphabet->count && alphabet->count < MAXIMUM_ALPHABET) {
+					alphabet->letters[alphabet->count++] = codepoints[j];
+				}
+			}
+		}
+	}
+}
+
+static void _appendWord(StringBuilder * word, const Alphabet * alphabet, uint64_t * state) {
+	char bytes[4];
+	const size_t length = 2 + _random(state) % 7;
+	for (size_t k = 0; k < length; ++k) {
+		const uint32_t letter = alphabet->letters[_random(state) % alphabet->count];
+		appendStringWithLength(word, bytes, encodeUtf8(letter, bytes));
+	}
+}
+
+static void _appendAsciiWord(StringBuilder * word, uint64_t * state) {
+	const size_t length = 2 + _random(state) % 7;
+	for (size_t k = 0; k < length; ++k) {
+		appendCharacter(word, 'a' + _random(state) % 26);
+	}
+}
+
+static void _generateWords(Corpus * corpus, const Alphabet * alphabet) {
+	uint64_t state = RANDOM_SEED;
+	StringBuilder word = {0};
+	for (size_t k = 0; k < WORD_COUNT; ++k) {
+		clearStringBuilder(&word);
+		_appendWord(&word, alphabet, &state);
+		_addText(corpus, peekStringBuilder(&word));
+	}
+	releaseStringBuilder(&word);
+}
+
+static void _generatePassage(Corpus * corpus, const Alphabet * alphabet, const boolean isMixed) {
+	uint64_t state = RANDOM_SEED;
+	StringBuilder passage = {0};
+	for (size_t k = 0; passage.length < PASSAGE_LENGTH; ++k) {
+		if (isMixed && k % 2 == 1) {
+			_appendAsciiWord(&passage, &state);
+		}
+		else {
+			_appendWord(&passage, alphabet, &state);
+		}
+		appendCharacter(&passage, k % 12 == 11 ? '.' : ' ');
+	}
+	_addText(corpus, peekStringBuilder(&passage));
+	releaseStringBuilder(&passage);
+}
+
+static size_t _allocationCount() {
+#if defined(COUNT_ALLOCATIONS)
+	return _allocations;
+#else
+	return 0;
+#endif
+}
+
+// Romanizes every text of the corpus once.
+static void _romanizeCorpus(const RomanizationScheme * scheme, const Corpus * corpus, const Api api, StringBuilder * output) {
+	for (size_t k = 0; k < corpus->count; ++k) {
+		if (api == API_APPEND) {
+			clearStringBuilder(output);
+			appendRomanization(output, scheme->language, scheme->scheme, corpus->texts[k]);
+		}
+		else {
+			free(romanize(scheme->language, scheme->scheme, corpus->texts[k]));
+		}
+	}
+}
+
+static void _measure(const RomanizationScheme * scheme, const char * name, const Corpus * corpus, const Api api, const double seconds) {
+	StringBuilder output = {0};
+	// The first round maps the tables and grows the builder, so it's not measured.
+	_romanizeCorpus(scheme, corpus, api, &output);
+	size_t rounds = 0;
+	const size_t allocations = _allocationCount();
+	const double start = _now();
+	double elapsed = 0;
+	do {
+		_romanizeCorpus(scheme, corpus, api, &output);
+		++rounds;
+		elapsed = _now() - start;
+	} while (elapsed < seconds);
+	const size_t calls = rounds * corpus->count;
+	const double perCall = (double) (_allocationCount() - allocations) / calls;
+	releaseStringBuilder(&output);
+
+	printf("%s\t%s\t%s\t%s\t%zu\t%zu\t%zu\t%.6f\t%.3f\t%.0f\t",
+		scheme->language, scheme->scheme, name, api == API_APPEND ? "append" : "romanize", calls,
+		rounds * corpus->bytes, rounds * corpus->codepoints, elapsed,
+		rounds * corpus->bytes / elapsed / 1e6, rounds * corpus->codepoints / elapsed);
+#if defined(COUNT_ALLOCATIONS)
+	printf("%.3f\n", perCall);
+#else
+	(void) perCall;
+	printf("NA\n");
+#endif
+	fflush(stdout);
+}
+
+static void _benchmarkScheme(const RomanizationScheme * scheme, const char * path, const double seconds) {
+	Corpus corpora[4] = {{0}};
+	const char * names[4] = {"words", "passage", "mixed", "real"};
+	_loadRealCorpus(&corpora[3], path, scheme->language);
+	Alphabet * alphabet = malloc(sizeof(Alphabet));
+	_collectAlphabet(alphabet, &corpora[3]);
+	if (alphabet->count == 0) {
+		fprintf(stderr, "RomanizerBenchmark: no corpus of '%s' (skipped)\n", scheme->language);
+		free(alphabet);
+		_releaseCorpus(&corpora[3]);
+		return;
+	}
+	_generateWords(&corpora[0], alphabet);
+	_generatePassage(&corpora[1], alphabet, false);
+	_generatePassage(&corpora[2], alphabet, true);
+	free(alphabet);
+
+	for (size_t k = 0; k < 4; ++k) {
+		_measure(scheme, names[k], &corpora[k], API_APPEND, seconds);
+		_measure(scheme, names[k], &corpora[k], API_ROMANIZE, seconds);
+		_releaseCorpus(&corpora[k]);
+	}
+}
+
+int main(const int count, char ** arguments) {
+	if (3 < count) {
+		_fail("usage: RomanizerBenchmark [corpus.tsv] [seconds]", "");
+	}
+	const char * path = 1 < count ? arguments[1] : BENCHMARK_CORPUS_PATH;
+	const double seconds = 2 < count ? atof(arguments[2]) : DEFAULT_SECONDS;
+	// Warnings are logged into the standard output, so they would break the
+	// table; only errors are logged (into the standard error).
+	setenv("LOGGING_LEVEL", "ERROR", 1);
+	initializePinyinDictionaryModule();
+
+	printf("language\tscheme\tcorpus\tapi\tcalls\tbytes\tcodepoints\tseconds\tmegabytes_per_second\tcodepoints_per_second\tallocations_per_call\n");
+	for (const RomanizationScheme * scheme = romanizationSchemes; scheme->language != NULL; ++scheme) {
+		_benchmarkScheme(scheme, path, seconds);
+	}
+	_benchmarkScheme(findRomanizationScheme("zh", NULL), path, seconds);
+
+	shutdownPinyinDictionaryModule();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include "UnitTests.h"
+#include "backend/code-generation/Generator.h"
+#include "backend/domain-specific/SemanticAnalyzer.h"
+#include "frontend/syntactic-analysis/SyntacticAnalyzer.h"
+#include "shared/StringBuilder.h"
+
+/**
+ * The program of an output test is generated with "generate" into a file, and
+ * pulled from an iterator in chunks of several sizes: both outputs must be the
+ * same, byte by byte.
+ */
+
+#define OUTPUT_ITERATOR_PROGRAM UNIT_TEST_RESOURCES "/output/01-incremental-blocks/input"
+
+static const size_t _capacities[] = {1, 2, 3, 7, 64, 4096, 1 << 20};
+
+/**
+ * Generates the program into a temporary directory, and returns the content
+ * of the main file (or NULL if it couldn't be generated).
+ */
+static char * _generateToFile(CompilerState * compilerState, bool isInput) {
+	char directory[] = "/tmp/langtex-unit-XXXXXX";
+	if (mkdtemp(directory) == NULL) {
+		return NULL;
+	}
+	generate(directory, "main.tex", isInput, false, 1, 0, compilerState);
+
+	char * path = concatenate(2, directory, "/main.tex");
+	FILE * file = fopen(path, "rb");
+	StringBuilder content = {0};
+	char chunk[4096];
+	size_t length;
+	while (file != NULL && 0 < (length = fread(chunk, 1, sizeof(chunk), file))) {
+		appendStringWithLength(&content, chunk, length);
+	}
+	if (file != NULL) {
+		fclose(file);
+	}
+	remove(path);
+	free(path);
+	path = concatenate(2, directory, "/preamble.tex");
+	remove(path);
+	free(path);
+	rmdir(directory);
+	return file == NULL ? NULL : buildString(&content);
+}
+
+/**
+ * Pulls the whole output from a new iterator, in chunks of at most the given
+ * capacity. Every chunk but the last one must be full.
+ */
+static char * _generateInChunks(CompilerState * compilerState, bool isInput, const size_t capacity) {
+	OutputIterator * iterator = createOutputIterator(compilerState, isInput);
+	StringBuilder content = {0};
+	char * buffer = malloc(capacity);
+	size_t length;
+	bool isFinished = false;
+	while (0 < (length = nextOutputChunk(iterator, buffer, capacity))) {
+		check(!isFinished, "A chunk of %zu bytes was short, but it wasn't the last one", capacity);
+		isFinished = length < capacity;
+		appendStringWithLength(&content, buffer, length);
+	}
+	check(nextOutputChunk(iterator, buffer, capacity) == 0, "The iterator restarted after its end");
+	free(buffer);
+	destroyOutputIterator(iterator);
+	return buildString(&content);
+}
+
+void testOutputIteratorInChunks() {
+	CompilerState compilerState = {
+		.abstractSyntaxtTree = NULL,
+		.succeed = false,
+		.blockCache = NULL
+	};
+	if (freopen(OUTPUT_ITERATOR_PROGRAM, "r", stdin) == NULL || parse(&compilerState) != ACCEPT) {
+		check(false, "The program %s couldn't be parsed", OUTPUT_ITERATOR_PROGRAM);
+		return;
+	}
+	Program * program = compilerState.abstractSyntaxtTree;
+	check(analyzeProgram(program, NULL) == SEMANTIC_ANALYSIS_ACCEPT, "The program was rejected");
+
+	for (int isInput = 0; isInput <= 1; ++isInput) {
+		char * expected = _generateToFile(&compilerState, isInput);
+		check(expected != NULL && expected[0] != '\0', "The program wasn't generated (input mode: %d)", isInput);
+		for (size_t k = 0; expected != NULL && k < sizeof(_capacities) / sizeof(size_t); ++k) {
+			char * actual = _generateInChunks(&compilerState, isInput, _capacities[k]);
+			check(strcmp(expected, actual) == 0, "Chunks of %zu bytes differ from the file (input mode: %d)", _capacities[k], isInput);
+			free(actual);
+		}
+		free(expected);
+	}
+
+	// An iterator can be released before the end of the output.
+	OutputIterator * iterator = createOutputIterator(&compilerState, false);
+	char buffer[16];
+	check(nextOutputChunk(iterator, buffer, sizeof(buffer)) == sizeof(buffer), "The first chunk wasn't full");
+	destroyOutputIterator(iterator);
+
+	releaseProgram(program);
+}
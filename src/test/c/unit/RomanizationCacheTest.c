@@ -0,0 +1,106 @@
+#include "UnitTests.h"
+#include "backend/romanizers/RomanizationCache.h"
+#include "shared/Utf8.h"
+#include <pthread.h>
+
+/**
+ * The cache is shared by the tasks of a parallel generation, so many threads
+ * look up the same keys at once (in different orders, so they collide on
+ * the same shards while they grow). Every one of them must get what
+ * "romanize" returns, and the same string for the same key.
+ */
+
+#define CACHE_THREADS 8
+#define CACHE_ROUNDS 4
+#define CACHE_WORDS 1024
+
+typedef struct {
+	const char * language;
+	const char * scheme;
+	char text[16];
+	char * romanization;
+} CachedWord;
+
+typedef struct {
+	RomanizationCache * cache;
+	CachedWord * words;
+	size_t first;
+	const char * results[CACHE_WORDS];
+	unsigned int mismatches;
+} CacheTask;
+
+static void * _lookUpWords(void * argument) {
+	CacheTask * task = argument;
+	for (size_t round = 0; round < CACHE_ROUNDS; ++round) {
+		for (size_t k = 0; k < CACHE_WORDS; ++k) {
+			const size_t index = (task->first + k) % CACHE_WORDS;
+			const CachedWord * word = &task->words[index];
+			const char * romanization = getRomanization(task->cache, word->language, word->scheme, word->text);
+			if (strcmp(romanization, word->romanization) != 0 || (task->results[index] != NULL && task->results[index] != romanization)) {
+				++task->mismatches;
+			}
+			task->results[index] = romanization;
+		}
+	}
+	return NULL;
+}
+
+void testRomanizationCacheInParallel() {
+	static const char * const russian[] = {"Москва", "столица", "России", "поезд", "ель", "съел"};
+	static const char * const schemes[] = {"rr", "mr", NULL};
+	CachedWord * words = calloc(CACHE_WORDS, sizeof(CachedWord));
+	for (size_t k = 0; k < CACHE_WORDS; ++k) {
+		CachedWord * word = &words[k];
+		if (k % 4 == 3) {
+			// A few Russian words, under both schemes.
+			word->language = "ru";
+			word->scheme = k % 8 == 3 ? "bgn" : "iso9";
+			snprintf(word->text, sizeof(word->text), "%s", russian[k / 8 % (sizeof(russian) / sizeof(char *))]);
+		}
+		else {
+			// Distinct Korean words of two syllables, under every scheme.
+			word->language = "ko";
+			word->scheme = schemes[k % 3];
+			const size_t length = encodeUtf8(0xAC00 + (k * 37) % 11172, word->text);
+			word->text[length + encodeUtf8(0xAC00 + (k * 101) % 11172, word->text + length)] = '\0';
+		}
+		word->romanization = romanize(word->language, word->scheme, word->text);
+	}
+
+	RomanizationCache * cache = createRomanizationCache();
+	pthread_t threads[CACHE_THREADS];
+	CacheTask * tasks = calloc(CACHE_THREADS, sizeof(CacheTask));
+	for (size_t k = 0; k < CACHE_THREADS; ++k) {
+		tasks[k] = (CacheTask) {.cache = cache, .words = words, .first = k * CACHE_WORDS / CACHE_THREADS};
+		pthread_create(&threads[k], NULL, _lookUpWords, &tasks[k]);
+	}
+	for (size_t k = 0; k < CACHE_THREADS; ++k) {
+		pthread_join(threads[k], NULL);
+	}
+
+	for (size_t k = 0; k < CACHE_THREADS; ++k) {
+		check(tasks[k].mismatches == 0, "Thread %zu got %u wrong romanizations", k, tasks[k].mismatches);
+		for (size_t w = 0; w < CACHE_WORDS; ++w) {
+			check(tasks[k].results[w] == tasks[0].results[w], "Threads 0 and %zu got different strings for %s", k, words[w].text);
+		}
+	}
+	const RomanizationCacheStatistics statistics = getRomanizationCacheStatistics(cache);
+	check(statistics.hits + statistics.misses == CACHE_THREADS * CACHE_ROUNDS * CACHE_WORDS, "The cache counted %zu lookups", statistics.hits + statistics.misses);
+
+	// Every word is cached by now.
+	for (size_t k = 0; k < CACHE_WORDS; ++k) {
+		getRomanization(cache, words[k].language, words[k].scheme, words[k].text);
+	}
+	check(getRomanizationCacheStatistics(cache).misses == statistics.misses, "The cache missed a word that was romanized");
+
+	// A deromanization isn't the romanization of the same input.
+	check(strcmp(getRomanization(cache, "ru", "bgn", "moskva"), "moskva") == 0, "The romanization of \"moskva\" changed it");
+	check(strcmp(getDeromanization(cache, "ru", "bgn", "moskva"), "москва") == 0, "The deromanization of \"moskva\" is the cached romanization");
+
+	destroyRomanizationCache(cache);
+	for (size_t k = 0; k < CACHE_WORDS; ++k) {
+		free(words[k].romanization);
+	}
+	free(tasks);
+	free(words);
+}
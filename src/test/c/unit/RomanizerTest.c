@@ -0,0 +1,176 @@
+#include "UnitTests.h"
+#include "backend/romanizers/romanize.h"
+#include "shared/StringBuilder.h"
+#include "shared/Utf8.h"
+
+/**
+ * Every romanization appends into the builder it's given, in a single pass
+ * over windows of the input, so what was already in the builder must be kept,
+ * and a long passage must be romanized as its parts are.
+ */
+
+typedef struct {
+	const char * language;
+	const char * text;
+} Sample;
+
+static const Sample _samples[] = {
+	{"ko", "서울특별시는 대한민국의 수도이다. 한국말을 배우고 있어요."},
+	{"ru", "Москва — столица России. Маяковский родился в Багдади."},
+	{"uk", "Всі люди народжуються вільними і рівними у своїй гідності та правах."},
+	{"el", "Όλοι οι άνθρωποι γεννιούνται ελεύθεροι και ίσοι στην αξιοπρέπεια."},
+	{"ja", "トウキョウ タワーは ミナトクに あります。"},
+	{"ka", "ყველა ადამიანი იბადება თავისუფალი და თანასწორი."},
+	{"he", "בְּרֵאשִׁית בָּרָא אֱלֹהִים אֵת הַשָּׁמַיִם וְאֵת הָאָרֶץ."},
+	{"zh", "我们学习中文。北京是中国的首都。"}
+};
+
+static const Sample * _findSample(const char * language) {
+	for (size_t k = 0; k < sizeof(_samples) / sizeof(Sample); ++k) {
+		if (strcmp(_samples[k].language, language) == 0) {
+			return &_samples[k];
+		}
+	}
+	return NULL;
+}
+
+static void _checkAppendRomanization(const char * language, const char * scheme, const char * text) {
+	const size_t repetitions = 64;
+	char * romanization = romanize(language, scheme, text);
+	check(romanization[0] != '\0', "The sample of %s (%s) has no romanization", language, scheme);
+
+	StringBuilder builder = {0};
+	appendString(&builder, "prefix ");
+	appendRomanization(&builder, language, scheme, text);
+	check(strncmp(peekStringBuilder(&builder), "prefix ", 7) == 0 && strcmp(peekStringBuilder(&builder) + 7, romanization) == 0,
+		"Appending the sample of %s (%s) after a prefix changed it: \"%s\"", language, scheme, peekStringBuilder(&builder));
+
+	// A passage far longer than a window.
+	StringBuilder passage = {0};
+	StringBuilder expected = {0};
+	for (size_t k = 0; k < repetitions; ++k) {
+		appendString(&passage, k == 0 ? "" : " ");
+		appendString(&passage, text);
+		appendString(&expected, k == 0 ? "" : " ");
+		appendString(&expected, romanization);
+	}
+	clearStringBuilder(&builder);
+	appendRomanization(&builder, language, scheme, peekStringBuilder(&passage));
+	check(strcmp(peekStringBuilder(&builder), peekStringBuilder(&expected)) == 0,
+		"The passage of %s (%s) isn't romanized as its parts", language, scheme);
+
+	releaseStringBuilder(&expected);
+	releaseStringBuilder(&passage);
+	releaseStringBuilder(&builder);
+	free(romanization);
+}
+
+void testAppendRomanization() {
+	for (const RomanizationScheme * scheme = romanizationSchemes; scheme->language != NULL; ++scheme) {
+		const Sample * sample = _findSample(scheme->language);
+		check(sample != NULL, "There's no sample of %s", scheme->language);
+		if (sample != NULL) {
+			_checkAppendRomanization(scheme->language, scheme->scheme, sample->text);
+		}
+	}
+	_checkAppendRomanization("zh", NULL, _findSample("zh")->text);
+}
+
+/**
+ * The Revised Romanization of every jamo, as the standard lists it (with the
+ * finals as they sound at the end of a word), so every precomposed syllable
+ * romanized alone must be its three parts.
+ */
+static const char * const _initials[] = {
+	"g", "kk", "n", "d", "tt", "r", "m", "b", "pp", "s", "ss", "", "j", "jj", "ch", "k", "t", "p", "h"
+};
+static const char * const _medials[] = {
+	"a", "ae", "ya", "yae", "eo", "e", "yeo", "ye", "o", "wa", "wae", "oe", "yo", "u", "wo", "we", "wi", "yu", "eu", "ui", "i"
+};
+static const char * const _finals[] = {
+	"", "k", "k", "k", "n", "n", "n", "t", "l", "k", "m", "l", "l", "l", "p", "l", "m", "p", "p", "t", "t", "ng", "t", "t", "k", "t", "p", "t"
+};
+
+void testRomanizeHangulSyllables() {
+	unsigned int mismatches = 0;
+	for (uint32_t syllable = 0; syllable < 19 * 21 * 28; ++syllable) {
+		char text[5] = {0};
+		char expected[16];
+		encodeUtf8(0xAC00 + syllable, text);
+		snprintf(expected, sizeof(expected), "%s%s%s", _initials[syllable / (21 * 28)], _medials[syllable / 28 % 21], _finals[syllable % 28]);
+		char * romanization = romanize("ko", "rr", text);
+		if (strcmp(romanization, expected) != 0 && mismatches++ < 8) {
+			check(false, "%s was romanized as \"%s\", not \"%s\"", text, romanization, expected);
+		}
+		free(romanization);
+	}
+	check(mismatches == 0, "%u syllables were romanized wrongly", mismatches);
+}
+
+typedef struct {
+	const char * text;
+	const char * romanization;
+} Romanization;
+
+/**
+ * Pointed Hebrew, romanized by hand. The points of a letter may come in any
+ * order (as normalized text sorts the sheva before the dagesh, for instance).
+ */
+static const Romanization _hebrew[] = {
+	// The shin and sin dots, and a sheva that starts a word.
+	{"בְּרֵאשִׁית", "bereshit"},
+	{"שָׂרָה", "sarah"},
+	{"שְׁמַע", "shema"},
+	{"שַׁבָּת", "shabat"},
+	// A bet or kaf with dagesh, and without it (or at the end of a word).
+	{"כֶּלֶב", "kelev"},
+	{"עִבְרִית", "ivrit"},
+	// The final forms.
+	{"מֶלֶךְ", "melekh"},
+	{"סוּף", "suf"},
+	// The vowel letters: holam male, shuruk, and yod after hiriq or tsere.
+	{"שָׁלוֹם, עוֹלָם!", "shalom, olam!"},
+	{"תּוֹרָה", "torah"},
+	{"בֵּית", "bet"},
+	{"אֱלֹהִים", "elohim"},
+	// Cantillation marks and the meteg are left out.
+	{"בָּֽרָ֑א", "bara"}
+};
+
+void testRomanizeHebrew() {
+	for (size_t k = 0; k < sizeof(_hebrew) / sizeof(Romanization); ++k) {
+		char * romanization = romanize("he", "academy", _hebrew[k].text);
+		check(strcmp(romanization, _hebrew[k].romanization) == 0, "%s was romanized as \"%s\", not \"%s\"", _hebrew[k].text, romanization, _hebrew[k].romanization);
+		free(romanization);
+	}
+
+	// A passage far longer than a window, with every word of the table.
+	StringBuilder passage = {0};
+	StringBuilder expected = {0};
+	while (passage.length <= 4096) {
+		for (size_t k = 0; k < sizeof(_hebrew) / sizeof(Romanization); ++k) {
+			appendString(&passage, _hebrew[k].text);
+			appendString(&passage, " ");
+			appendString(&expected, _hebrew[k].romanization);
+			appendString(&expected, " ");
+		}
+	}
+	char * romanization = romanize("he", "academy", peekStringBuilder(&passage));
+	check(strcmp(romanization, peekStringBuilder(&expected)) == 0, "A passage of %zu bytes was romanized as \"%s\"", passage.length, romanization);
+	free(romanization);
+	releaseStringBuilder(&expected);
+	releaseStringBuilder(&passage);
+}
+
+void testRomanizePinyinWithoutReading() {
+	// The seed dictionary has no reading of "龘" (but it has the others).
+	char * romanization = romanize("zh", NULL, "我走龘了。");
+	check(strcmp(romanization, "wǒ zǒu 龘 le.") == 0, "A character without a reading was romanized as \"%s\"", romanization);
+	free(romanization);
+
+	// It's reported once, however many times it's written.
+	StringBuilder missing = {0};
+	const size_t count = findMissingPinyinReadings(&missing, "我走龘了。龘");
+	check(count == 1 && strcmp(peekStringBuilder(&missing), " 龘") == 0, "The characters without a reading are \"%s\"", peekStringBuilder(&missing));
+	releaseStringBuilder(&missing);
+}
@@ -0,0 +1,69 @@
+#include "UnitTests.h"
+#include "shared/String.h"
+#include "shared/StringBuilder.h"
+
+/**
+ * The escaping of LaTeX special characters skips clean text 16 bytes at a
+ * time (with SSE2), and the rest byte by byte, so every special character is
+ * tried at every position of texts of several lengths, against a plain
+ * escaping of one byte at a time.
+ */
+
+static const char _specials[] = "\\{}$&#^_~%";
+
+static char * _escapeLatexByByte(const char * string) {
+	StringBuilder builder = {0};
+	for (const char * c = string; *c != '\0'; ++c) {
+		switch (*c) {
+			case '\\': appendString(&builder, "\\textbackslash{}"); break;
+			case '^': appendString(&builder, "\\textasciicircum{}"); break;
+			case '~': appendString(&builder, "\\textasciitilde{}"); break;
+			case '{': case '}': case '$': case '&': case '#': case '_': case '%':
+				appendCharacter(&builder, '\\');
+				appendCharacter(&builder, *c);
+				break;
+			default:
+				appendCharacter(&builder, *c);
+		}
+	}
+	return buildString(&builder);
+}
+
+static void _checkEscapeLatex(const char * string) {
+	char * expected = _escapeLatexByByte(string);
+	char * actual = escapeLatex(string);
+	check(strcmp(expected, actual) == 0, "\"%s\" was escaped as \"%s\"", string, actual);
+	free(actual);
+	free(expected);
+}
+
+void testEscapeLatex() {
+	// Clean text, with a non-ASCII character (as its bytes are signed).
+	const char * clean = "Ωmega text: 0123456789 ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnopqrstuvwxyz";
+	char text[128];
+	for (size_t length = 0; length <= 48; ++length) {
+		memcpy(text, clean, length);
+		text[length] = '\0';
+		_checkEscapeLatex(text);
+		for (size_t position = 0; position < length; ++position) {
+			for (const char * special = _specials; *special != '\0'; ++special) {
+				memcpy(text, clean, length);
+				text[length] = '\0';
+				text[position] = *special;
+				_checkEscapeLatex(text);
+				// And every other special character after it.
+				for (size_t next = position + 1; next < length; next += 3) {
+					text[next] = _specials[next % (sizeof(_specials) - 1)];
+				}
+				_checkEscapeLatex(text);
+			}
+		}
+	}
+
+	// Only special characters, longer than a few chunks.
+	for (size_t k = 0; k < 100; ++k) {
+		text[k] = _specials[k % (sizeof(_specials) - 1)];
+	}
+	text[100] = '\0';
+	_checkEscapeLatex(text);
+}
@@ -0,0 +1,108 @@
+#include "UnitTests.h"
+#include "backend/romanizers/Transliterator.h"
+#include "shared/StringBuilder.h"
+#include "shared/Utf8.h"
+
+/**
+ * The transliteration applies the longest rule whose context matches, with
+ * the real tables of a few languages (the Korean ones over conjoining jamo,
+ * and the Hebrew one over sorted points, as their romanizers feed them). A
+ * match may span the codepoints of several feeds, so every text is fed whole,
+ * and in pieces of every size.
+ */
+
+typedef struct {
+	const char * language;
+	const char * scheme;
+	const char * text;
+	const char * transliteration;
+} Transliteration;
+
+static const Transliteration _transliterations[] = {
+	// The "e" starts a word, follows a vowel, or follows a hard sign.
+	{"ru", "bgn", "ель", "yel"},
+	{"ru", "bgn", "Елена где?", "Yelena gde?"},
+	{"ru", "bgn", "(ел)", "(yel)"},
+	{"ru", "bgn", "поезд", "poyezd"},
+	{"ru", "bgn", "съел", "syel"},
+	// The liquid is doubled across syllables, and a final stays alone.
+	{"ko", "rr", "달라", "dalla"},
+	{"ko", "rr", "달", "dal"},
+	// The plosives are voiceless at the start of a word, and "n'g" isn't "ng".
+	{"ko", "mr", "가 아가", "ka aga"},
+	{"ko", "mr", "한국", "han'guk"},
+	// A bet without dagesh ends a word, and a sheva starts one.
+	{"he", "academy", "אב", "v"},
+	{"he", "academy", "אבא", "b"},
+	{"he", "academy", "בְרא", "ver"},
+	{"he", "academy", "אבְר", "vr"},
+	// A vav with dagesh is a vowel, unless it has a vowel of its own.
+	{"he", "academy", "וּ", "u"},
+	{"he", "academy", "וַּ", "va"},
+	{"he", "academy", "ִיָ", "iya"}
+};
+
+static const TransliterationTable * _findTable(const char * language, const char * scheme) {
+	for (const RomanizationScheme * entry = romanizationSchemes; entry->language != NULL; ++entry) {
+		if (strcmp(entry->language, language) == 0 && strcmp(entry->scheme, scheme) == 0) {
+			return entry->table;
+		}
+	}
+	return NULL;
+}
+
+/** Transliterates the codepoints, fed in pieces of the given size. */
+static char * _transliterateInPieces(const TransliterationTable * table, const uint32_t * codepoints, const size_t count, const size_t size) {
+	StringBuilder output = {0};
+	Transliterator transliterator;
+	beginTransliteration(&transliterator, table);
+	for (size_t k = 0; k < count; k += size) {
+		feedTransliteration(&transliterator, &output, codepoints + k, size < count - k ? size : count - k);
+	}
+	endTransliteration(&transliterator, &output);
+	return buildString(&output);
+}
+
+static void _checkTransliteration(const TransliterationTable * table, const char * text, const char * expected) {
+	const size_t length = strlen(text);
+	uint32_t * codepoints = calloc(length + 1, sizeof(uint32_t));
+	size_t consumed;
+	const size_t count = decodeUtf8(text, length, codepoints, length + 1, &consumed);
+
+	StringBuilder output = {0};
+	transliterate(&output, table, text);
+	check(strcmp(peekStringBuilder(&output), expected) == 0, "The transliteration \"%.40s...\" came out as \"%.40s...\"", expected, peekStringBuilder(&output));
+	releaseStringBuilder(&output);
+	const size_t sizes[] = {1, 2, 3, 5, 7, 64, TRANSLITERATOR_BUFFER + 1};
+	for (size_t k = 0; k < sizeof(sizes) / sizeof(size_t); ++k) {
+		char * transliteration = _transliterateInPieces(table, codepoints, count, sizes[k]);
+		check(strcmp(transliteration, expected) == 0, "The transliteration \"%.40s...\" came out as \"%.40s...\" in pieces of %zu", expected, transliteration, sizes[k]);
+		free(transliteration);
+	}
+	free(codepoints);
+}
+
+void testTransliterate() {
+	for (size_t k = 0; k < sizeof(_transliterations) / sizeof(Transliteration); ++k) {
+		const Transliteration * transliteration = &_transliterations[k];
+		const TransliterationTable * table = _findTable(transliteration->language, transliteration->scheme);
+		check(table != NULL, "There's no table of %s (%s)", transliteration->language, transliteration->scheme);
+		if (table == NULL) {
+			continue;
+		}
+		_checkTransliteration(table, transliteration->text, transliteration->transliteration);
+
+		// Longer than the buffer, so the contexts are held across drains.
+		StringBuilder text = {0};
+		StringBuilder expected = {0};
+		for (size_t r = 0; r < 2 * TRANSLITERATOR_BUFFER / 3; ++r) {
+			appendString(&text, transliteration->text);
+			appendString(&text, " ");
+			appendString(&expected, transliteration->transliteration);
+			appendString(&expected, " ");
+		}
+		_checkTransliteration(table, peekStringBuilder(&text), peekStringBuilder(&expected));
+		releaseStringBuilder(&expected);
+		releaseStringBuilder(&text);
+	}
+}
@@ -0,0 +1,84 @@
+#include "UnitTests.h"
+#include "backend/code-generation/BlockCache.h"
+#include "backend/code-generation/Generator.h"
+#include "backend/domain-specific/SemanticAnalyzer.h"
+#include "backend/romanizers/PinyinDictionary.h"
+#include "frontend/lexical-analysis/FlexActions.h"
+#include "frontend/lexical-analysis/SourceInput.h"
+#include "frontend/syntactic-analysis/BisonActions.h"
+#include "frontend/syntactic-analysis/LangTeXAST.h"
+#include "frontend/syntactic-analysis/SyntacticAnalyzer.h"
+
+/**
+ * Runs every unit test, with the same modules of the compiler that the main
+ * entry-point initializes, and reports each one as the other tests do. The
+ * exit status is 1 if any of them failed.
+ */
+
+typedef struct {
+	const char * name;
+	void (*run)();
+} UnitTest;
+
+static const UnitTest _unitTests[] = {
+	{"append-romanization", testAppendRomanization},
+	{"decode-utf8", testDecodeUtf8},
+	{"escape-latex", testEscapeLatex},
+	{"output-iterator-in-chunks", testOutputIteratorInChunks},
+	{"romanization-cache-in-parallel", testRomanizationCacheInParallel},
+	{"romanize-hangul-syllables", testRomanizeHangulSyllables},
+	{"romanize-hebrew", testRomanizeHebrew},
+	{"romanize-pinyin-without-reading", testRomanizePinyinWithoutReading},
+	{"transliterate", testTransliterate}
+};
+
+static unsigned int _failures = 0;
+
+void failUnitTest(const char * file, const int line, const char * const format, ...) {
+	va_list arguments;
+	va_start(arguments, format);
+	fprintf(stderr, "        %s:%d: ", file, line);
+	vfprintf(stderr, format, arguments);
+	fprintf(stderr, "\n");
+	va_end(arguments);
+	++_failures;
+}
+
+int main(const int count, char ** arguments) {
+	initializeFlexActionsModule();
+	initializeSourceInputModule();
+	initializeBisonActionsModule();
+	initializeSyntacticAnalyzerModule();
+	initializeRenameMeModule();
+	initializeSemanticAnalyzer();
+	initializeBlockCacheModule();
+	initializeRomanizationCacheModule();
+	initializePinyinDictionaryModule();
+	initializeGeneratorModule();
+
+	int status = 0;
+	for (size_t k = 0; k < sizeof(_unitTests) / sizeof(UnitTest); ++k) {
+		const unsigned int failures = _failures;
+		_unitTests[k].run();
+		if (failures == _failures) {
+			printf("    %s, \033[0;32mand it does\033[0m\n", _unitTests[k].name);
+		}
+		else {
+			status = 1;
+			printf("    %s, \033[0;31mbut it fails\033[0m (%u checks)\n", _unitTests[k].name, _failures - failures);
+		}
+		fflush(stdout);
+	}
+
+	shutdownGeneratorModule();
+	shutdownPinyinDictionaryModule();
+	shutdownRomanizationCacheModule();
+	shutdownBlockCacheModule();
+	shutdownSemanticAnalyzer();
+	shutdownRenameMeModule();
+	shutdownSyntacticAnalyzerModule();
+	shutdownSourceInputModule();
+	shutdownBisonActionsModule();
+	shutdownFlexActionsModule();
+	return status;
+}
@@ -0,0 +1,36 @@
+#ifndef UNIT_TESTS_HEADER
+#define UNIT_TESTS_HEADER
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef UNIT_TEST_RESOURCES
+	#define UNIT_TEST_RESOURCES "src/test/c"
+#endif
+
+/**
+ * Checks a condition of the running unit test. If it doesn't hold, the test
+ * fails with the given message (a format string), but it keeps running.
+ */
+#define check(condition, ...) \
+	do { \
+		if (!(condition)) failUnitTest(__FILE__, __LINE__, __VA_ARGS__); \
+	} while (0)
+
+/** Reports a failure of the running unit test (see "check"). */
+void failUnitTest(const char * file, const int line, const char * const format, ...);
+
+/** The unit tests, one per function. */
+
+void testAppendRomanization();
+void testDecodeUtf8();
+void testEscapeLatex();
+void testOutputIteratorInChunks();
+void testRomanizationCacheInParallel();
+void testRomanizeHangulSyllables();
+void testRomanizeHebrew();
+void testRomanizePinyinWithoutReading();
+void testTransliterate();
+
+#endif
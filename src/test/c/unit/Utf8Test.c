@@ -0,0 +1,146 @@
+#include "UnitTests.h"
+#include "shared/Utf8.h"
+
+/**
+ * The validation and the decoding of UTF-8 skip ASCII runs 16 bytes at a
+ * time (with SSE2), and decode the rest sequence by sequence, so they are
+ * compared with a plain decoder of one sequence at a time, over random texts
+ * that mix ASCII runs, every length of sequence, and invalid and truncated
+ * ones, at every alignment.
+ */
+
+#define UTF8_TEXT_COUNT 2000
+#define UTF8_MAXIMUM_LENGTH 96
+
+static uint64_t _state = 0x9E3779B97F4A7C15ull;
+
+static uint32_t _random(const uint32_t bound) {
+	_state ^= _state << 13;
+	_state ^= _state >> 7;
+	_state ^= _state << 17;
+	return (uint32_t) (_state % bound);
+}
+
+/**
+ * Decodes the sequence at the start of the bytes, and returns its length, or
+ * zero if it's not well-formed (as it's cut short by the end of the bytes).
+ */
+static size_t _decodeSequenceByByte(const unsigned char * bytes, const size_t length, uint32_t * codepoint) {
+	size_t size = bytes[0] < 0x80 ? 1 : bytes[0] < 0xC0 ? 0 : bytes[0] < 0xE0 ? 2 : bytes[0] < 0xF0 ? 3 : bytes[0] < 0xF8 ? 4 : 0;
+	if (size == 0 || length < size) {
+		return 0;
+	}
+	uint32_t value = size == 1 ? bytes[0] : bytes[0] & (0x7F >> size);
+	for (size_t k = 1; k < size; ++k) {
+		if ((bytes[k] & 0xC0) != 0x80) {
+			return 0;
+		}
+		value = value << 6 | (bytes[k] & 0x3F);
+	}
+	static const uint32_t minimums[] = {0, 0, 0x80, 0x800, 0x10000};
+	if (value < minimums[size] || 0x10FFFF < value || (0xD800 <= value && value <= 0xDFFF)) {
+		return 0;
+	}
+	*codepoint = value;
+	return size;
+}
+
+/** Appends a random piece of text, and returns its length. */
+static size_t _appendRandomPiece(unsigned char * bytes) {
+	char encoded[4];
+	size_t length = 0;
+	switch (_random(6)) {
+		case 0:
+			// An ASCII run, often longer than a chunk.
+			length = _random(40);
+			for (size_t k = 0; k < length; ++k) {
+				bytes[k] = (unsigned char) (0x20 + _random(0x5F));
+			}
+			return length;
+		case 1:
+			length = encodeUtf8(0x80 + _random(0x800 - 0x80), encoded);
+			break;
+		case 2: {
+			uint32_t codepoint = 0x800 + _random(0x10000 - 0x800);
+			length = encodeUtf8(0xD800 <= codepoint && codepoint <= 0xDFFF ? 0xFFFD : codepoint, encoded);
+			break;
+		}
+		case 3:
+			length = encodeUtf8(0x10000 + _random(0x110000 - 0x10000), encoded);
+			break;
+		case 4:
+			// A random byte, mostly an invalid one.
+			bytes[0] = (unsigned char) (0x80 + _random(0x80));
+			return 1;
+		default: {
+			// The leading bytes with a narrower second byte, with any second byte.
+			static const unsigned char leads[] = {0xE0, 0xED, 0xF0, 0xF4, 0xC0, 0xC1, 0xF5};
+			bytes[0] = leads[_random(sizeof(leads))];
+			bytes[1] = (unsigned char) (0x80 + _random(0x40));
+			return 2;
+		}
+	}
+	memcpy(bytes, encoded, length);
+	return length;
+}
+
+static void _checkUtf8(const unsigned char * bytes, const size_t length) {
+	uint32_t expected[UTF8_MAXIMUM_LENGTH + 64];
+	size_t offsets[UTF8_MAXIMUM_LENGTH + 64];
+	size_t count = 0;
+	size_t validLength = length;
+	for (size_t k = 0; k < length; ++count) {
+		offsets[count] = k;
+		const size_t size = _decodeSequenceByByte(bytes + k, length - k, &expected[count]);
+		if (size == 0) {
+			expected[count] = REPLACEMENT_CHARACTER;
+			validLength = validLength < k ? validLength : k;
+		}
+		k += size == 0 ? 1 : size;
+	}
+	offsets[count] = length;
+
+	const char * text = (const char *) bytes;
+	check(validUtf8Length(text, length) == validLength, "The valid prefix has %zu bytes, not %zu", validUtf8Length(text, length), validLength);
+
+	// The whole text, and in pieces of a few capacities.
+	const size_t capacities[] = {length + 1, 1, 5, 16, 17, 33};
+	for (size_t c = 0; c < sizeof(capacities) / sizeof(size_t); ++c) {
+		uint32_t actual[UTF8_MAXIMUM_LENGTH + 64];
+		size_t decoded = 0;
+		size_t consumed = 0;
+		while (consumed < length) {
+			size_t step;
+			const size_t capacity = capacities[c];
+			const size_t stepCount = decodeUtf8(text + consumed, length - consumed, actual + decoded, capacity, &step);
+			if (stepCount == 0 || capacity < stepCount || offsets[decoded + stepCount] != consumed + step) {
+				check(false, "A decoding of at most %zu codepoints stopped at a wrong byte (%zu)", capacity, consumed + step);
+				return;
+			}
+			decoded += stepCount;
+			consumed += step;
+		}
+		check(decoded == count && memcmp(actual, expected, count * sizeof(uint32_t)) == 0, "Decoding at most %zu codepoints at once, %zu differ", capacities[c], count);
+	}
+}
+
+void testDecodeUtf8() {
+	unsigned char buffer[16 + UTF8_MAXIMUM_LENGTH + 64];
+	for (size_t t = 0; t < UTF8_TEXT_COUNT; ++t) {
+		const size_t alignment = t % 16;
+		const size_t maximum = 1 + _random(UTF8_MAXIMUM_LENGTH);
+		size_t length = 0;
+		while (length < maximum) {
+			length += _appendRandomPiece(buffer + alignment + length);
+		}
+		_checkUtf8(buffer + alignment, length);
+		// Every text must be checked cut short too.
+		_checkUtf8(buffer + alignment, length - 1);
+	}
+
+	// A truncated sequence is only the beginning of a well-formed one.
+	check(isTruncatedUtf8("\xE4\xB8", 2), "A sequence that lacks a byte isn't truncated");
+	check(!isTruncatedUtf8("\xE4\x41", 2), "An invalid sequence is truncated");
+	check(!isTruncatedUtf8("\xE0\x80", 2), "An overlong sequence is truncated");
+	check(!isTruncatedUtf8("\xE4\xB8\xAD", 3), "A complete sequence is truncated");
+}